@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Graph.h"
+#include "Readout.h"  // reduceSum / reduceMax / reduceMin
 #include <vector>
 #include <functional>
 #include <numeric>
@@ -60,28 +61,30 @@ namespace OutputConverter {
       return std::fabs(a - b);
     }
 
+    // The graph aggregators below reduce in fixed blocks, in parallel for
+    // large inputs, with pairwise totals (see Readout.h); the result does not
+    // depend on the thread count.
+
     // sum of all node scores
     inline float sumGraph(const NodeScores& scores) {
-      return std::accumulate(scores.begin(), scores.end(), 0.0f);
+      return reduceSum(scores.data(), scores.size());
     }
 
     // mean of all node scores
     inline float meanGraph(const NodeScores& scores) {
       if (scores.empty()) return 0.0f;
-      return std::accumulate(scores.begin(), scores.end(), 0.0f)
+      return reduceSum(scores.data(), scores.size())
            / static_cast<float>(scores.size());
     }
 
     // maximum of all node scores
     inline float maxGraph(const NodeScores& scores) {
-      if (scores.empty()) return 0.0f;
-      return *std::max_element(scores.begin(), scores.end());
+      return reduceMax(scores.data(), scores.size());
     }
 
     // minimum of all node scores
     inline float minGraph(const NodeScores& scores) {
-      if (scores.empty()) return 0.0f;
-      return *std::min_element(scores.begin(), scores.end());
+      return reduceMin(scores.data(), scores.size());
     }
 
   }  // namespace DefaultAgg
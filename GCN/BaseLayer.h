@@ -1,6 +1,12 @@
 // BaseLayer.h
 #pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 #include <vector>
+#include "CompressedAdjacency.h"
+#include "HubSplit.h"
+#include "SparseFeatures.h"
 using namespace std;
 
 // BaseLayer provides a standard interface for all GNN layers (GAT, GCN, GraphSAGE, etc.)
@@ -8,9 +14,124 @@ class BaseLayer {
 public:
     virtual ~BaseLayer() {}
 
+    // dimensions of the feature vectors the layer consumes and produces
+    virtual int get_input_dim() const = 0;
+    virtual int get_output_dim() const = 0;
+
+    // Name of the layer type in model specs and checkpoints ("gcn", "sage", "gat").
+    // Layers that cannot be rebuilt from a checkpoint return an empty name.
+    virtual string type_name() const { return ""; }
+
+    // The layer's learnable tensors as flat buffers, in a fixed order
+    // (checkpoints store and restore them in this order)
+    virtual vector<vector<float>*> parameters() { return {}; }
+
+    // Gradient buffers matching parameters() one to one (same order and sizes).
+    // backward() adds into them; they are allocated on first use.
+    virtual vector<vector<float>*> gradients() { return {}; }
+
+    // Clears the accumulated gradients before the next training step
+    void zero_gradients() {
+        for (vector<float>* grad : gradients()) {
+            fill(grad->begin(), grad->end(), 0.0f);
+        }
+    }
+
     // Forward pass interface to be overridden by all derived GNN layers
     virtual vector<vector<float>> forward(
         const vector<vector<float>>& node_features,
         const vector<vector<int>>& adjacency_list
     ) = 0;
+
+    // Computes only the output rows listed in 'rows' and stores them in out[row].
+    // 'out' must already have one entry per node; rows that already hold the
+    // output dimension are overwritten in place, so buffers placed by the caller
+    // (e.g. on a NUMA node) stay where they are. Different threads may call this
+    // concurrently on the same layer for disjoint row sets.
+    // The default runs the full forward pass and copies the requested rows.
+    virtual void forward_rows(
+        const vector<vector<float>>& node_features,
+        const vector<vector<int>>& adjacency_list,
+        const vector<int>& rows,
+        vector<vector<float>>& out
+    ) {
+        vector<vector<float>> full = forward(node_features, adjacency_list);
+        for (int row : rows) {
+            out[row] = full[row];
+        }
+    }
+
+    // forward_rows over a local view of a larger graph (a partition or a
+    // receptive field): only the listed rows need complete neighbour lists,
+    // other nodes may have partial or empty ones, and degrees[v] is the true
+    // degree of every local node. Layers whose kernel reads the degree of a
+    // neighbour (GCN) must take it from 'degrees'; the default ignores it.
+    virtual void forward_local_rows(
+        const vector<vector<float>>& node_features,
+        const vector<vector<int>>& adjacency_list,
+        const vector<int>& /* degrees */,
+        const vector<int>& rows,
+        vector<vector<float>>& out
+    ) {
+        forward_rows(node_features, adjacency_list, rows, out);
+    }
+
+    // Forward pass over a compressed adjacency. Layers that can aggregate
+    // straight from the decode-on-the-fly iterators override this; the default
+    // expands the lists and falls back to the plain forward pass.
+    virtual vector<vector<float>> forward(
+        const vector<vector<float>>& node_features,
+        const CompressedAdjacency& adjacency
+    ) {
+        return forward(node_features, adjacency.to_adjacency_list());
+    }
+
+    // Forward pass over sparse input activations (e.g. the ReLU output of the
+    // previous layer). Layers with a sparse kernel skip the zero entries and
+    // must produce the same result as the dense pass; the default densifies.
+    virtual vector<vector<float>> forward(
+        const SparseFeatures& node_features,
+        const vector<vector<int>>& adjacency_list
+    ) {
+        return forward(node_features.to_dense(), adjacency_list);
+    }
+
+    // Degree-aware forward pass (see HubSplit.h): ordinary nodes run the normal
+    // kernel in parallel chunks, nodes above options.degree_threshold have their
+    // neighbour list split into segments handled by different workers, whose
+    // partial results are then merged. Non-hub rows match forward() exactly; hub
+    // rows differ only by summation order. The default runs the plain forward pass.
+    virtual vector<vector<float>> forward_split(
+        const vector<vector<float>>& node_features,
+        const vector<vector<int>>& adjacency_list,
+        const HubSplitOptions& /* options */
+    ) {
+        return forward(node_features, adjacency_list);
+    }
+
+    // Forward pass used during training; returns the same values as forward().
+    // With keep_intermediates the layer also stores the intermediate aggregates
+    // backward() needs. Without it nothing is kept and backward() recomputes
+    // them from the layer input (activation checkpointing: one extra aggregation
+    // per step instead of a [number of nodes][dim] buffer per layer).
+    virtual vector<vector<float>> forward_train(
+        const vector<vector<float>>& node_features,
+        const vector<vector<int>>& adjacency_list,
+        bool /* keep_intermediates */
+    ) {
+        return forward(node_features, adjacency_list);
+    }
+
+    // Backward pass: given the layer input, the output of forward_train() and
+    // dLoss/dOutput, adds the parameter gradients into gradients() and returns
+    // dLoss/dInput. The ReLU mask is taken from the output itself. Throws
+    // logic_error if the stored intermediates belong to an input of another size.
+    virtual vector<vector<float>> backward(
+        const vector<vector<float>>& /* node_features */,
+        const vector<vector<int>>& /* adjacency_list */,
+        const vector<vector<float>>& /* output */,
+        const vector<vector<float>>& /* grad_output */
+    ) {
+        throw logic_error("layer '" + type_name() + "' does not support training");
+    }
 };
@@ -0,0 +1,54 @@
+// BoundedQueue.h
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+using namespace std;
+
+// BoundedQueue is a blocking multi-producer / multi-consumer FIFO with a fixed
+// capacity. A full queue blocks producers, which is how a slow pipeline stage
+// applies backpressure to the stages in front of it.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity) {}
+
+    // Blocks while the queue is full. Returns false if the queue was closed.
+    bool push(T item) {
+        unique_lock<mutex> lock(m);
+        not_full.wait(lock, [&] { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is empty. Returns nullopt once the queue is
+    // closed and drained.
+    optional<T> pop() {
+        unique_lock<mutex> lock(m);
+        not_empty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) return nullopt;
+        T item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return item;
+    }
+
+    // No more pushes; consumers drain what is left and then see nullopt
+    void close() {
+        lock_guard<mutex> lock(m);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+private:
+    size_t capacity;
+    deque<T> items;
+    bool closed = false;
+    mutex m;
+    condition_variable not_empty, not_full;
+};
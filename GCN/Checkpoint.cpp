@@ -0,0 +1,200 @@
+// Checkpoint.cpp
+
+#include "Checkpoint.h"
+#include "GATL.h"
+#include "GCNL.h"
+#include "GraphSage.h"
+#include "OutputWriter.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char kMagic[8] = {'G', 'N', 'N', 'C', 'K', 'P', 'T', '1'};
+const uint32_t kVersion = 1;
+const size_t kAlignment = 64;
+const int kMaxParams = 2;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_layers;
+    char reserved[48];
+};
+
+struct TensorRecord {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct LayerRecord {
+    char type[16];
+    uint32_t input_dim;
+    uint32_t output_dim;
+    uint32_t num_params;
+    uint32_t reserved;
+    TensorRecord params[kMaxParams];
+};
+
+static_assert(sizeof(FileHeader) == 64, "checkpoint header must be 64 bytes");
+static_assert(sizeof(LayerRecord) == 64, "checkpoint layer record must be 64 bytes");
+
+size_t align_up(size_t n) {
+    return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+void require_little_endian() {
+    uint16_t probe = 1;
+    unsigned char first;
+    memcpy(&first, &probe, 1);
+    if (first != 1) throw runtime_error("checkpoints are only supported on little-endian hosts");
+}
+
+// Builds a layer of the given type around already loaded parameters
+unique_ptr<BaseLayer> make_layer(const string& type, int input_dim, int output_dim,
+                                 vector<vector<float>>& params) {
+    if (type == "gcn" && params.size() == 1)
+        return unique_ptr<BaseLayer>(new GCNLayer(input_dim, output_dim, std::move(params[0])));
+    if (type == "sage" && params.size() == 1)
+        return unique_ptr<BaseLayer>(new GraphSAGELayer(input_dim, output_dim, std::move(params[0])));
+    if (type == "gat" && params.size() == 2)
+        return unique_ptr<BaseLayer>(new GATLayer(input_dim, output_dim, std::move(params[0]), std::move(params[1])));
+    throw runtime_error("checkpoint holds unsupported layer '" + type + "'");
+}
+
+// Read-only mapping of a whole file, unmapped on scope exit
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("cannot open checkpoint " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw runtime_error("cannot stat checkpoint " + path);
+        }
+        size = st.st_size;
+        if (size > 0) {
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw runtime_error("cannot map checkpoint " + path);
+            }
+            data = static_cast<const char*>(p);
+            madvise(p, size, MADV_WILLNEED); // start reading the weights ahead of the copies
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data) munmap(const_cast<char*>(data), size);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+}  // namespace
+
+void save_checkpoint(const string& path, const LayerStack& stack) {
+    require_little_endian();
+
+    FileHeader header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_layers = stack.size();
+
+    // lay out the records and the tensor payload
+    vector<LayerRecord> records(stack.size());
+    size_t offset = align_up(sizeof(FileHeader) + records.size() * sizeof(LayerRecord));
+    for (size_t l = 0; l < stack.size(); l++) {
+        BaseLayer& layer = stack.layer(l);
+        string type = layer.type_name();
+        vector<vector<float>*> params = layer.parameters();
+        if (type.empty() || type.size() >= sizeof(records[l].type) || params.size() > kMaxParams) {
+            throw runtime_error("layer " + to_string(l) + " cannot be stored in a checkpoint");
+        }
+        LayerRecord& record = records[l];
+        memcpy(record.type, type.data(), type.size());
+        record.input_dim = layer.get_input_dim();
+        record.output_dim = layer.get_output_dim();
+        record.num_params = params.size();
+        for (size_t p = 0; p < params.size(); p++) {
+            record.params[p] = {offset, params[p]->size()};
+            offset = align_up(offset + params[p]->size() * sizeof(float));
+        }
+    }
+
+    OutputWriter::BufferedFile out(path);
+    size_t written = 0;
+    auto write = [&](const void* data, size_t size) {
+        out.write(data, size);
+        written += size;
+    };
+    auto pad_to = [&](size_t target) {
+        static const char zeros[kAlignment] = {};
+        while (written < target) write(zeros, min(kAlignment, target - written));
+    };
+
+    write(&header, sizeof(header));
+    write(records.data(), records.size() * sizeof(LayerRecord));
+    for (size_t l = 0; l < stack.size(); l++) {
+        vector<vector<float>*> params = stack.layer(l).parameters();
+        for (size_t p = 0; p < params.size(); p++) {
+            pad_to(records[l].params[p].offset);
+            write(params[p]->data(), params[p]->size() * sizeof(float));
+        }
+    }
+    out.flush();
+}
+
+LayerStack load_checkpoint(const string& path) {
+    require_little_endian();
+    MappedFile file(path);
+    if (file.size < sizeof(FileHeader)) throw runtime_error(path + " is not a checkpoint");
+
+    FileHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) throw runtime_error(path + " is not a checkpoint");
+    if (header.version != kVersion) throw runtime_error(path + ": unsupported checkpoint version");
+    if (sizeof(FileHeader) + static_cast<size_t>(header.num_layers) * sizeof(LayerRecord) > file.size) {
+        throw runtime_error(path + ": truncated checkpoint");
+    }
+
+    LayerStack stack;
+    for (uint32_t l = 0; l < header.num_layers; l++) {
+        LayerRecord record;
+        memcpy(&record, file.data + sizeof(FileHeader) + l * sizeof(LayerRecord), sizeof(record));
+        if (record.num_params > kMaxParams) throw runtime_error(path + ": corrupt layer record");
+
+        vector<vector<float>> params(record.num_params);
+        for (uint32_t p = 0; p < record.num_params; p++) {
+            const TensorRecord& t = record.params[p];
+            if (t.offset > file.size || t.count > (file.size - t.offset) / sizeof(float)) {
+                throw runtime_error(path + ": truncated checkpoint");
+            }
+            const float* src = reinterpret_cast<const float*>(file.data + t.offset);
+            params[p].assign(src, src + t.count);
+        }
+        string type(record.type, strnlen(record.type, sizeof(record.type)));
+        try {
+            stack.add_layer(make_layer(type, record.input_dim, record.output_dim, params));
+        } catch (const invalid_argument& e) {
+            throw runtime_error(path + ": " + e.what());
+        }
+    }
+    return stack;
+}
+
+bool is_checkpoint_file(const string& path) {
+    ifstream in(path, ios::binary);
+    char magic[sizeof(kMagic)];
+    return in.read(magic, sizeof(magic)) && memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
@@ -0,0 +1,32 @@
+// Checkpoint.h
+
+#pragma once
+#include "LayerStack.h"
+#include <string>
+using namespace std;
+
+// Binary checkpoints of a layer stack: layer types, dimensions and every
+// parameter tensor in the packed row-major layout the kernels use.
+//
+// Layout (little-endian, all offsets from the start of the file):
+//   [0, 64)        header: char[8] "GNNCKPT1", uint32 version, uint32 num_layers
+//   [64, ...)      one 64-byte record per layer:
+//                    char[16] type name ("gcn", "sage", "gat", zero padded)
+//                    uint32 input_dim, uint32 output_dim, uint32 num_params, uint32 reserved
+//                    kMaxParams x { uint64 offset, uint64 count }  (float32 elements)
+//   payload        the tensors, each starting on a 64-byte boundary
+//
+// Loading maps the file with mmap and copies each tensor straight into the
+// layer's weight buffer, so cold start costs little more than faulting in
+// the weight pages.
+
+// Writes the stack to 'path'; throws runtime_error on I/O failure or if a
+// layer has no checkpoint type name
+void save_checkpoint(const string& path, const LayerStack& stack);
+
+// Rebuilds a stack from a checkpoint; throws runtime_error if the file is
+// missing, truncated, not a checkpoint or holds layers whose dims do not chain
+LayerStack load_checkpoint(const string& path);
+
+// True if 'path' starts with the checkpoint magic
+bool is_checkpoint_file(const string& path);
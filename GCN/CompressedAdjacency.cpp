@@ -0,0 +1,167 @@
+// CompressedAdjacency.cpp
+
+#include "CompressedAdjacency.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// extra zero bytes after the stream so the word-at-a-time decoder may read past the end
+const size_t kPadding = 8;
+
+// high bit of every byte in a 64-bit word
+const uint64_t kContinuationBits = 0x8080808080808080ULL;
+
+// Appends 'value' as an unsigned LEB128 varint
+void encode_varint(uint32_t value, vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Decodes one varint starting at p and advances p past it
+inline uint32_t decode_varint(const uint8_t*& p) {
+    uint32_t value = *p & 0x7F;
+    int shift = 7;
+    while (*p++ & 0x80) {
+        value |= static_cast<uint32_t>(*p & 0x7F) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+// Decodes 'count' gap-coded neighbours starting after 'previous' into out.
+// Runs of eight one-byte gaps (the common case for graphs with locality) are
+// detected with a single 64-bit test and decoded without per-byte branches.
+const uint8_t* decode_run(const uint8_t* p, int previous, int count, int* out) {
+    int i = 0;
+    while (count - i >= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        if ((word & kContinuationBits) == 0) {
+            for (int k = 0; k < 8; k++) {
+                previous += p[k];
+                out[i + k] = previous;
+            }
+            p += 8;
+            i += 8;
+        } else {
+            previous += static_cast<int>(decode_varint(p));
+            out[i++] = previous;
+        }
+    }
+    for (; i < count; i++) {
+        previous += static_cast<int>(decode_varint(p));
+        out[i] = previous;
+    }
+    return p;
+}
+
+}  // namespace
+
+CompressedAdjacency::Iterator::Iterator(const uint8_t* data, int count)
+    : cursor(data), remaining(count), previous(0), buffer_pos(0), buffer_len(0)
+{
+    refill();
+}
+
+CompressedAdjacency::Iterator& CompressedAdjacency::Iterator::operator++() {
+    if (++buffer_pos == buffer_len) {
+        refill();
+    }
+    return *this;
+}
+
+// Decodes the next batch of up to kBlockSize neighbours
+void CompressedAdjacency::Iterator::refill() {
+    int n = min(remaining, kBlockSize);
+    buffer_pos = 0;
+    buffer_len = n;
+    if (n == 0) return;
+    cursor = decode_run(cursor, previous, n, buffer);
+    previous = buffer[n - 1];
+    remaining -= n;
+}
+
+CompressedAdjacency::CompressedAdjacency(const vector<vector<int>>& adjacency_list) {
+    int n_nodes = adjacency_list.size();
+    offsets.resize(n_nodes + 1);
+    degrees.resize(n_nodes);
+    skip_begin.resize(n_nodes + 1);
+
+    vector<int> sorted;
+    for (int i = 0; i < n_nodes; i++) {
+        sorted = adjacency_list[i];
+        sort(sorted.begin(), sorted.end());
+
+        offsets[i] = data.size();
+        degrees[i] = sorted.size();
+        skip_begin[i] = skips.size();
+
+        int previous = 0;
+        for (size_t k = 0; k < sorted.size(); k++) {
+            if (k > 0 && k % kBlockSize == 0) {
+                skips.push_back({previous, static_cast<uint32_t>(data.size() - offsets[i])});
+            }
+            encode_varint(static_cast<uint32_t>(sorted[k] - previous), data);
+            previous = sorted[k];
+        }
+    }
+    offsets[n_nodes] = data.size();
+    skip_begin[n_nodes] = skips.size();
+
+    data.resize(data.size() + kPadding, 0);
+    data.shrink_to_fit();
+    skips.shrink_to_fit();
+}
+
+void CompressedAdjacency::decode(int node, vector<int>& out) const {
+    out.resize(degrees[node]);
+    decode_run(data.data() + offsets[node], 0, degrees[node], out.data());
+}
+
+bool CompressedAdjacency::contains(int node, int target) const {
+    const SkipEntry* first = skips.data() + skip_begin[node];
+    const SkipEntry* last = skips.data() + skip_begin[node + 1];
+
+    // last block whose base lies below target; block 0 if there is none
+    const SkipEntry* it = upper_bound(first, last, target,
+        [](int value, const SkipEntry& entry) { return value <= entry.base; });
+    int block = it - first;
+
+    const uint8_t* p = data.data() + offsets[node];
+    int previous = 0;
+    if (block > 0) {
+        p += (it - 1)->byte_offset;
+        previous = (it - 1)->base;
+    }
+
+    int count = min(kBlockSize, degrees[node] - block * kBlockSize);
+    int values[kBlockSize];
+    decode_run(p, previous, count, values);
+    return binary_search(values, values + count, target);
+}
+
+vector<vector<int>> CompressedAdjacency::to_adjacency_list() const {
+    vector<vector<int>> adjacency_list(num_nodes());
+    for (int i = 0; i < num_nodes(); i++) {
+        decode(i, adjacency_list[i]);
+    }
+    return adjacency_list;
+}
+
+size_t CompressedAdjacency::memory_bytes() const {
+    return data.size() * sizeof(uint8_t)
+         + offsets.size() * sizeof(size_t)
+         + degrees.size() * sizeof(int)
+         + skip_begin.size() * sizeof(size_t)
+         + skips.size() * sizeof(SkipEntry);
+}
+
+size_t CompressedAdjacency::uncompressed_bytes() const {
+    size_t total_neighbors = 0;
+    for (int d : degrees) total_neighbors += d;
+    return (offsets.size() + total_neighbors) * sizeof(int);
+}
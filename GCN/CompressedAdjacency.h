@@ -0,0 +1,105 @@
+// CompressedAdjacency.h
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+// CompressedAdjacency stores the neighbour lists of a graph in a compact
+// read-only form for graphs whose plain adjacency list does not fit in memory.
+// Every neighbour list is sorted, gap (delta) coded and written as byte-aligned
+// varints. Lists longer than one block get a skip index so lookups can jump
+// straight to the block that may hold a given neighbour.
+class CompressedAdjacency {
+public:
+    // number of neighbours covered by one skip-index entry / one decode batch
+    static constexpr int kBlockSize = 64;
+
+    // Entry of the per-node skip index: decoding the block starts from
+    // 'base' (the last neighbour id of the previous block) at 'byte_offset'
+    // relative to the start of the node's encoded list.
+    struct SkipEntry {
+        int base;
+        uint32_t byte_offset;
+    };
+
+    // Marks the end of a neighbour range (C++17 allows begin/end types to differ)
+    struct Sentinel {};
+
+    // Forward iterator decoding one node's neighbours on the fly.
+    // Neighbours are decoded kBlockSize at a time into a small local buffer,
+    // so consuming a list never materialises it in full.
+    class Iterator {
+    public:
+        Iterator(const uint8_t* data, int count);
+
+        int operator*() const { return buffer[buffer_pos]; }
+        Iterator& operator++();
+        bool operator!=(Sentinel) const { return buffer_pos < buffer_len; }
+        bool operator==(Sentinel) const { return buffer_pos >= buffer_len; }
+
+    private:
+        const uint8_t* cursor; // next undecoded byte
+        int remaining;         // neighbours not decoded yet
+        int previous;          // last decoded neighbour id (delta base)
+        int buffer[kBlockSize];
+        int buffer_pos;
+        int buffer_len;
+
+        void refill();
+    };
+
+    // Iterable view over the neighbours of one node, usable in range-for loops
+    // in place of adjacency_list[node].
+    class NeighborRange {
+    public:
+        NeighborRange(const uint8_t* data, int count) : data(data), count(count) {}
+        Iterator begin() const { return Iterator(data, count); }
+        Sentinel end() const { return Sentinel{}; }
+        int size() const { return count; }
+
+    private:
+        const uint8_t* data;
+        int count;
+    };
+
+    CompressedAdjacency() = default;
+
+    // Encodes the given adjacency list. Neighbour ids are sorted per node,
+    // duplicates (multi-edges, self-loops added twice) are kept.
+    explicit CompressedAdjacency(const vector<vector<int>>& adjacency_list);
+
+    int num_nodes() const { return static_cast<int>(degrees.size()); }
+
+    // number of neighbours of a node (same as adjacency_list[node].size())
+    int degree(int node) const { return degrees[node]; }
+
+    // decode-on-the-fly view of the sorted neighbours of a node
+    NeighborRange neighbors(int node) const {
+        return NeighborRange(data.data() + offsets[node], degrees[node]);
+    }
+
+    // Decodes all neighbours of a node into 'out' (resized to the degree)
+    void decode(int node, vector<int>& out) const;
+
+    // Returns true if 'target' is a neighbour of 'node'; uses the skip index
+    // to decode at most one block.
+    bool contains(int node, int target) const;
+
+    // Expands back into a plain adjacency list (sorted neighbour order)
+    vector<vector<int>> to_adjacency_list() const;
+
+    // Bytes used by the compressed representation (data + offsets + skip index)
+    size_t memory_bytes() const;
+
+    // Bytes the same lists take as 32-bit ids in a flat CSR layout
+    size_t uncompressed_bytes() const;
+
+private:
+    vector<uint8_t> data;          // varint stream of all lists, padded for word reads
+    vector<size_t> offsets;        // byte offset of each node's list in 'data'
+    vector<int> degrees;           // neighbour count per node
+    vector<size_t> skip_begin;     // first skip entry of each node, [num_nodes + 1]
+    vector<SkipEntry> skips;       // skip entries of all nodes with degree > kBlockSize
+};
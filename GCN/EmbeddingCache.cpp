@@ -0,0 +1,388 @@
+// EmbeddingCache.cpp
+
+#include "EmbeddingCache.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+const uint64_t kFnvOffset = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+
+void fnv_update(uint64_t& hash, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash ^= p[i];
+        hash *= kFnvPrime;
+    }
+}
+
+// FNV-1a over 32-bit words: four times fewer steps than byte-wise for the
+// large feature and adjacency buffers of a content hash
+void fnv_update_words(uint64_t& hash, const void* data, size_t words) {
+    const uint32_t* p = static_cast<const uint32_t*>(data);
+    for (size_t i = 0; i < words; i++) {
+        hash ^= p[i];
+        hash *= kFnvPrime;
+    }
+}
+
+}  // namespace
+
+vector<uint64_t> layer_prefix_hashes(const LayerStack& stack) {
+    vector<uint64_t> hashes;
+    uint64_t hash = kFnvOffset;
+    for (size_t l = 0; l < stack.size(); l++) {
+        BaseLayer& layer = stack.layer(l);
+        string type = layer.type_name();
+        int32_t dims[2] = {layer.get_input_dim(), layer.get_output_dim()};
+        fnv_update(hash, type.data(), type.size() + 1);
+        fnv_update(hash, dims, sizeof(dims));
+        for (const vector<float>* tensor : layer.parameters()) {
+            uint64_t count = tensor->size();
+            fnv_update(hash, &count, sizeof(count));
+            fnv_update(hash, tensor->data(), tensor->size() * sizeof(float));
+        }
+        hashes.push_back(hash);
+    }
+    return hashes;
+}
+
+size_t EmbeddingCache::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = kFnvOffset;
+    fnv_update(hash, &key.graph_id, sizeof(key.graph_id));
+    fnv_update(hash, &key.graph_version, sizeof(key.graph_version));
+    fnv_update(hash, &key.stack_hash, sizeof(key.stack_hash));
+    fnv_update(hash, &key.depth, sizeof(key.depth));
+    return static_cast<size_t>(hash);
+}
+
+uint64_t EmbeddingCache::content_hash(const Graph& graph) {
+    uint64_t hash = kFnvOffset;
+    uint64_t sizes[2] = {graph.node_features.size(), graph.adjacency_list.size()};
+    fnv_update(hash, sizes, sizeof(sizes));
+    static_assert(sizeof(float) == 4 && sizeof(int) == 4, "content hash reads 32-bit words");
+    for (const vector<float>& row : graph.node_features) {
+        uint64_t count = row.size();
+        fnv_update(hash, &count, sizeof(count));
+        fnv_update_words(hash, row.data(), row.size());
+    }
+    for (const vector<int>& neighbors : graph.adjacency_list) {
+        uint64_t count = neighbors.size();
+        fnv_update(hash, &count, sizeof(count));
+        fnv_update_words(hash, neighbors.data(), neighbors.size());
+    }
+    return hash;
+}
+
+pair<uint64_t, uint64_t> EmbeddingCache::graph_key(const Graph& graph) const {
+    if (options.key_on_content) return {content_hash(graph), 0};
+    return {graph.id, graph.version};
+}
+
+EmbeddingCache::EmbeddingCache(const EmbeddingCacheOptions& options) : options(options) {
+    if (options.spill_path.empty() || options.spill_budget_bytes == 0) return;
+
+    spill_fd = open(options.spill_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (spill_fd < 0) {
+        throw runtime_error("EmbeddingCache: cannot create spill file " + options.spill_path);
+    }
+    void* mapping = MAP_FAILED;
+    if (ftruncate(spill_fd, options.spill_budget_bytes) == 0) {
+        mapping = mmap(nullptr, options.spill_budget_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, spill_fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        close(spill_fd);
+        unlink(options.spill_path.c_str());
+        throw runtime_error("EmbeddingCache: cannot map spill file " + options.spill_path);
+    }
+    spill_base = static_cast<char*>(mapping);
+    spill_free[0] = options.spill_budget_bytes;
+}
+
+EmbeddingCache::~EmbeddingCache() {
+    if (spill_fd >= 0) {
+        munmap(spill_base, options.spill_budget_bytes);
+        close(spill_fd);
+        unlink(options.spill_path.c_str());
+    }
+}
+
+vector<vector<float>> EmbeddingCache::forward(const LayerStack& stack, const Graph& graph) {
+    int n_layers = stack.size();
+    if (n_layers == 0) return graph.node_features;
+    vector<uint64_t> hashes = layer_prefix_hashes(stack);
+    pair<uint64_t, uint64_t> graph_identity = graph_key(graph);
+    auto key_of = [&](int l) { return Key{graph_identity.first, graph_identity.second, hashes[l], l}; };
+
+    // resume after the deepest layer cached in full
+    vector<vector<float>> current;
+    int start = -1;
+    {
+        lock_guard<mutex> lock(m);
+        for (int l = n_layers - 1; l >= 0; l--) {
+            if (load(key_of(l), current, nullptr)) {
+                start = l;
+                counters.full_hits++;
+                break;
+            }
+        }
+    }
+
+    for (int l = start + 1; l < n_layers; l++) {
+        BaseLayer& layer = stack.layer(l);
+        const vector<vector<float>>& input = l == 0 ? graph.node_features : current;
+
+        vector<vector<float>> output;
+        vector<int> invalid_rows;
+        bool cached;
+        {
+            lock_guard<mutex> lock(m);
+            cached = load(key_of(l), output, &invalid_rows);
+        }
+
+        if (cached) {
+            // patch the rows dropped by edge updates
+            layer.forward_rows(input, graph.adjacency_list, invalid_rows, output);
+        } else {
+            output = layer.forward(input, graph.adjacency_list);
+        }
+
+        {
+            lock_guard<mutex> lock(m);
+            if (cached) {
+                counters.partial_hits++;
+                counters.rows_recomputed += invalid_rows.size();
+            } else {
+                counters.misses++;
+            }
+            store(key_of(l), output);
+        }
+        current = std::move(output);
+    }
+    return current;
+}
+
+void EmbeddingCache::add_edges(Graph& graph, const vector<pair<int, int>>& edges) {
+    for (const pair<int, int>& edge : edges) {
+        if (edge.first < 0 || edge.first >= graph.num_nodes || edge.second < 0 || edge.second >= graph.num_nodes) {
+            throw out_of_range("EmbeddingCache: edge references a node outside the graph");
+        }
+    }
+    pair<uint64_t, uint64_t> old_identity = graph_key(graph);
+    for (const pair<int, int>& edge : edges) {
+        graph.add_edge(edge.first, edge.second);
+    }
+    pair<uint64_t, uint64_t> new_identity = graph_key(graph);
+    if (new_identity == old_identity) return; // no edges
+
+    lock_guard<mutex> lock(m);
+    vector<Key> affected;
+    int max_depth = -1;
+    for (const auto& item : entries) {
+        if (item.first.graph_id == old_identity.first && item.first.graph_version == old_identity.second) {
+            affected.push_back(item.first);
+            max_depth = max(max_depth, item.first.depth);
+        }
+    }
+    if (affected.empty()) return;
+
+    // hop distance from the nearest endpoint, up to the largest radius needed
+    unordered_map<int, int> distance;
+    vector<int> frontier;
+    for (const pair<int, int>& edge : edges) {
+        for (int v : {edge.first, edge.second}) {
+            if (distance.emplace(v, 0).second) frontier.push_back(v);
+        }
+    }
+    vector<vector<int>> within(max_depth + 2); // nodes at exactly distance d
+    within[0] = frontier;
+    for (int d = 1; d <= max_depth + 1; d++) {
+        for (int v : within[d - 1]) {
+            for (int u : graph.adjacency_list[v]) {
+                if (distance.emplace(u, d).second) within[d].push_back(u);
+            }
+        }
+    }
+
+    for (const Key& old_key : affected) {
+        Key new_key{new_identity.first, new_identity.second, old_key.stack_hash, old_key.depth};
+        if (entries.count(new_key)) {
+            // content keys: the updated graph is already cached (e.g. as another input)
+            erase(old_key);
+            continue;
+        }
+        auto node = entries.extract(old_key);
+        Entry& entry = node.mapped();
+        for (int d = 0; d <= old_key.depth + 1; d++) {
+            entry.invalid_rows.insert(entry.invalid_rows.end(), within[d].begin(), within[d].end());
+        }
+        sort(entry.invalid_rows.begin(), entry.invalid_rows.end());
+        entry.invalid_rows.erase(unique(entry.invalid_rows.begin(), entry.invalid_rows.end()),
+                                 entry.invalid_rows.end());
+
+        node.key() = new_key;
+        *entry.lru = new_key;
+        bool stale = static_cast<int>(entry.invalid_rows.size()) >= entry.rows;
+        entries.insert(std::move(node));
+        if (stale) erase(new_key); // nothing left worth keeping
+    }
+}
+
+void EmbeddingCache::clear() {
+    lock_guard<mutex> lock(m);
+    while (!lru.empty()) {
+        erase(lru.back());
+    }
+}
+
+EmbeddingCacheStats EmbeddingCache::stats() const {
+    lock_guard<mutex> lock(m);
+    return counters;
+}
+
+bool EmbeddingCache::load(const Key& key, vector<vector<float>>& rows, vector<int>* invalid_rows) {
+    auto it = entries.find(key);
+    if (it == entries.end()) return false;
+    Entry& entry = it->second;
+    if (!invalid_rows && !entry.invalid_rows.empty()) return false;
+
+    lru.splice(lru.begin(), lru, entry.lru);
+    if (entry.spilled) {
+        unspill(entry);
+        enforce_budget(key);
+    }
+
+    rows.assign(entry.rows, vector<float>());
+    for (int r = 0; r < entry.rows; r++) {
+        const float* row = entry.data.data() + static_cast<size_t>(r) * entry.dim;
+        rows[r].assign(row, row + entry.dim);
+    }
+    if (invalid_rows) *invalid_rows = entry.invalid_rows;
+    return true;
+}
+
+void EmbeddingCache::store(const Key& key, const vector<vector<float>>& rows) {
+    if (entries.count(key)) erase(key);
+
+    Entry entry;
+    entry.rows = rows.size();
+    entry.dim = rows.empty() ? 0 : rows[0].size();
+    entry.data.resize(entry.bytes() / sizeof(float));
+    for (int r = 0; r < entry.rows; r++) {
+        copy(rows[r].begin(), rows[r].end(), entry.data.begin() + static_cast<size_t>(r) * entry.dim);
+    }
+
+    lru.push_front(key);
+    entry.lru = lru.begin();
+    Entry& stored = entries.emplace(key, std::move(entry)).first->second;
+    counters.memory_bytes += stored.bytes();
+
+    // larger than the whole memory budget: straight to the spill file, or not at all
+    if (stored.bytes() > options.memory_budget_bytes) {
+        counters.evictions++;
+        if (!spill(stored)) erase(key);
+        return;
+    }
+    enforce_budget(key);
+}
+
+void EmbeddingCache::erase(const Key& key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) return;
+    Entry& entry = it->second;
+    if (entry.spilled) {
+        spill_release(entry.spill_offset, entry.bytes());
+        counters.spill_bytes -= entry.bytes();
+    } else {
+        counters.memory_bytes -= entry.bytes();
+    }
+    lru.erase(entry.lru);
+    entries.erase(it);
+}
+
+// Evicts least recently used in-memory outputs (never 'keep') until the payload fits
+void EmbeddingCache::enforce_budget(const Key& keep) {
+    while (counters.memory_bytes > options.memory_budget_bytes) {
+        auto victim = find_if(lru.rbegin(), lru.rend(), [&](const Key& key) {
+            return !(key == keep) && !entries.find(key)->second.spilled;
+        });
+        if (victim == lru.rend()) break;
+
+        Key key = *victim;
+        counters.evictions++;
+        if (!spill(entries.find(key)->second)) erase(key);
+    }
+}
+
+// Moves an in-memory entry into the spill file, dropping the oldest spilled
+// entries if there is no room; false if it still does not fit
+bool EmbeddingCache::spill(Entry& entry) {
+    if (spill_fd < 0 || entry.bytes() > options.spill_budget_bytes) return false;
+
+    size_t offset;
+    while (!spill_allocate(entry.bytes(), offset)) {
+        auto oldest = find_if(lru.rbegin(), lru.rend(), [&](const Key& key) {
+            return entries.find(key)->second.spilled;
+        });
+        if (oldest == lru.rend()) return false;
+        erase(*oldest);
+    }
+
+    memcpy(spill_base + offset, entry.data.data(), entry.bytes());
+    counters.memory_bytes -= entry.bytes();
+    counters.spill_bytes += entry.bytes();
+    counters.spills++;
+    entry.spilled = true;
+    entry.spill_offset = offset;
+    vector<float>().swap(entry.data);
+    return true;
+}
+
+void EmbeddingCache::unspill(Entry& entry) {
+    entry.data.resize(entry.bytes() / sizeof(float));
+    memcpy(entry.data.data(), spill_base + entry.spill_offset, entry.bytes());
+    spill_release(entry.spill_offset, entry.bytes());
+    counters.spill_bytes -= entry.bytes();
+    counters.memory_bytes += entry.bytes();
+    entry.spilled = false;
+}
+
+// First-fit allocation from the spill file's free list
+bool EmbeddingCache::spill_allocate(size_t bytes, size_t& offset) {
+    if (bytes == 0) {
+        offset = 0;
+        return true;
+    }
+    for (auto it = spill_free.begin(); it != spill_free.end(); ++it) {
+        if (it->second < bytes) continue;
+        offset = it->first;
+        size_t remaining = it->second - bytes;
+        spill_free.erase(it);
+        if (remaining > 0) spill_free[offset + bytes] = remaining;
+        return true;
+    }
+    return false;
+}
+
+// Returns a region to the free list, merging it with free neighbours
+void EmbeddingCache::spill_release(size_t offset, size_t bytes) {
+    if (bytes == 0) return;
+    auto next = spill_free.lower_bound(offset);
+    if (next != spill_free.end() && offset + bytes == next->first) {
+        bytes += next->second;
+        next = spill_free.erase(next);
+    }
+    if (next != spill_free.begin()) {
+        auto previous = prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += bytes;
+            return;
+        }
+    }
+    spill_free[offset] = bytes;
+}
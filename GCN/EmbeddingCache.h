@@ -0,0 +1,135 @@
+// EmbeddingCache.h
+
+#pragma once
+#include "Graph.h"
+#include "LayerStack.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Hash of a stack prefix: entry l covers layers [0, l] (type names, dimensions
+// and every parameter value, FNV-1a). Stacks that share their first layers
+// share the leading hashes, so a cached layer output serves both.
+vector<uint64_t> layer_prefix_hashes(const LayerStack& stack);
+
+struct EmbeddingCacheOptions {
+    size_t memory_budget_bytes = size_t(256) << 20; // in-memory layer outputs (LRU beyond this)
+    string spill_path;                              // file for evicted outputs; empty = no spill
+    size_t spill_budget_bytes = 0;                  // size of the spill file
+
+    // Identify graphs by a hash of their features and neighbour lists instead
+    // of (Graph::id, Graph::version). Costs one pass over the graph per call,
+    // but also catches direct member writes that skipped touch(), and lets
+    // equal graphs loaded separately (e.g. repeated batch inputs) share entries.
+    bool key_on_content = false;
+};
+
+struct EmbeddingCacheStats {
+    long long full_hits = 0;        // layers loaded as a whole from the cache
+    long long partial_hits = 0;     // layers patched after an edge update
+    long long misses = 0;           // layers computed from scratch
+    long long rows_recomputed = 0;  // rows recomputed while patching
+    long long evictions = 0;        // outputs dropped from memory (spilled or discarded)
+    long long spills = 0;           // outputs written to the spill file
+    size_t memory_bytes = 0;        // current in-memory payload
+    size_t spill_bytes = 0;         // current spill-file payload
+};
+
+// EmbeddingCache keeps the output of every layer of the stacks it runs,
+// keyed by (graph id, graph version, stack prefix hash, depth).
+// Graph::version only moves on add_edge / set_node_feature / touch(), so a
+// graph edited through its public members without touch() would be served
+// stale rows; enable key_on_content when callers cannot guarantee that.
+//
+// forward() resumes after the deepest layer whose output is cached in full,
+// so rerunning an unchanged stack on an unchanged graph costs one copy, and a
+// stack that extends a cached one only runs its new layers.
+//
+// add_edges() updates the graph and moves the graph's cached outputs to the
+// new version, dropping only the rows the new edges can reach: layer l (0 based)
+// loses the rows within l + 1 hops of an endpoint. The next forward() recomputes
+// just those rows with forward_rows.
+//
+// Outputs beyond the memory budget are evicted least recently used first into
+// an mmap-backed spill file (when configured) and read back on demand.
+// All member functions are thread-safe.
+class EmbeddingCache {
+public:
+    explicit EmbeddingCache(const EmbeddingCacheOptions& options = EmbeddingCacheOptions());
+    ~EmbeddingCache();
+
+    EmbeddingCache(const EmbeddingCache&) = delete;
+    EmbeddingCache& operator=(const EmbeddingCache&) = delete;
+
+    // Same result as stack.forward(graph.node_features, graph.adjacency_list)
+    vector<vector<float>> forward(const LayerStack& stack, const Graph& graph);
+
+    // Adds undirected edges to 'graph' (Graph::add_edge) and invalidates the
+    // affected rows of its cached outputs
+    void add_edges(Graph& graph, const vector<pair<int, int>>& edges);
+
+    // Drops every cached output
+    void clear();
+
+    // Content hash used by key_on_content (features and neighbour lists)
+    static uint64_t content_hash(const Graph& graph);
+
+    EmbeddingCacheStats stats() const;
+
+private:
+    // (graph_id, graph_version) part of a key: Graph::id / version, or the content hash and 0
+    pair<uint64_t, uint64_t> graph_key(const Graph& graph) const;
+
+    struct Key {
+        uint64_t graph_id;
+        uint64_t graph_version;
+        uint64_t stack_hash;
+        int depth;
+        bool operator==(const Key& other) const {
+            return graph_id == other.graph_id && graph_version == other.graph_version
+                && stack_hash == other.stack_hash && depth == other.depth;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    // One cached layer output, [rows][dim] row-major, in memory or in the spill file
+    struct Entry {
+        int rows = 0;
+        int dim = 0;
+        vector<float> data;          // in memory (empty when spilled)
+        bool spilled = false;
+        size_t spill_offset = 0;     // byte offset in the spill file
+        vector<int> invalid_rows;    // rows dropped by edge updates, sorted
+        list<Key>::iterator lru;     // position in 'lru' (front = most recent)
+
+        size_t bytes() const { return static_cast<size_t>(rows) * dim * sizeof(float); }
+    };
+
+    EmbeddingCacheOptions options;
+    mutable mutex m;
+    unordered_map<Key, Entry, KeyHash> entries;
+    list<Key> lru;
+    EmbeddingCacheStats counters;
+
+    // spill file: mapping plus first-fit free list (offset -> size)
+    int spill_fd = -1;
+    char* spill_base = nullptr;
+    map<size_t, size_t> spill_free;
+
+    // Copies an entry out (promoting spilled data back into memory); false if absent
+    bool load(const Key& key, vector<vector<float>>& rows, vector<int>* invalid_rows);
+    void store(const Key& key, const vector<vector<float>>& rows);
+    void erase(const Key& key);
+    void enforce_budget(const Key& keep);
+    bool spill(Entry& entry);
+    void unspill(Entry& entry);
+    bool spill_allocate(size_t bytes, size_t& offset);
+    void spill_release(size_t offset, size_t bytes);
+};
@@ -1,26 +1,56 @@
 // GATLayer.cpp
 
 #include "GATL.h"
-#include <random>
+#include "WeightInit.h"
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Softmax state of one hub segment: scores are taken relative to max_score,
+// so partials with different maxima can be rescaled onto a common one
+struct SoftmaxPartial {
+    float max_score = -INFINITY;
+    float sum_exp = 0.0f;   // sum of exp(score - max_score)
+    vector<float> weighted; // sum of exp(score - max_score) * z_j
+};
+
+// Folds 'source' into 'target' (log-sum-exp combine)
+void merge_softmax(SoftmaxPartial& target, const SoftmaxPartial& source) {
+    float max_score = max(target.max_score, source.max_score);
+    float target_scale = exp(target.max_score - max_score);
+    float source_scale = exp(source.max_score - max_score);
+    target.sum_exp = target.sum_exp * target_scale + source.sum_exp * source_scale;
+    for (size_t o = 0; o < target.weighted.size(); o++) {
+        target.weighted[o] = target.weighted[o] * target_scale + source.weighted[o] * source_scale;
+    }
+    target.max_score = max_score;
+}
+
+}  // namespace
 
 // Constructor with Xavier initialization
-GATLayer::GATLayer(int input_dim, int output_dim) : input_dim(input_dim), output_dim(output_dim) {
-    W.resize(input_dim, vector<float>(output_dim));
+GATLayer::GATLayer(int input_dim, int output_dim)
+    : GATLayer(input_dim, output_dim, random_seed()) {}
+
+// Xavier initialization from a fixed seed; W and a use independent sub-streams
+GATLayer::GATLayer(int input_dim, int output_dim, uint64_t seed) : input_dim(input_dim), output_dim(output_dim) {
+    W.resize(input_dim * output_dim);
     a.resize(2 * output_dim);
 
     float limit = sqrt(6.0f / (input_dim + output_dim));
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<> dis(0, limit);
-
-    for (int i = 0; i < input_dim; i++)
-        for (int j = 0; j < output_dim; j++)
-            W[i][j] = dis(gen);
+    init_uniform(W, 0.0f, limit, derive_seed(seed, 0));
+    init_uniform(a, 0.0f, limit, derive_seed(seed, 1));
+}
 
-    for (int i = 0; i < 2 * output_dim; i++)
-        a[i] = dis(gen);
+// Existing parameters
+GATLayer::GATLayer(int input_dim, int output_dim, vector<float> W, vector<float> a)
+    : input_dim(input_dim), output_dim(output_dim), W(std::move(W)), a(std::move(a)) {
+    if (this->W.size() != static_cast<size_t>(input_dim) * output_dim
+        || this->a.size() != 2 * static_cast<size_t>(output_dim)) {
+        throw invalid_argument("GATLayer: parameter sizes do not match dimensions");
+    }
 }
 
 // ReLU activation
@@ -38,7 +68,17 @@ vector<float> GATLayer::linear_transform(const vector<float>& features) {
     vector<float> z(output_dim, 0.0f);
     for (int o = 0; o < output_dim; o++)
         for (int d = 0; d < input_dim; d++)
-            z[o] += features[d] * W[d][o];
+            z[o] += features[d] * W[d * output_dim + o];
+    return z;
+}
+
+// Linear transformation of a sparse row; accumulates over the non-zero
+// input dimensions in ascending order, matching the dense version
+vector<float> GATLayer::linear_transform(const SparseFeatures& node_features, int node) {
+    vector<float> z(output_dim, 0.0f);
+    for (int o = 0; o < output_dim; o++)
+        for (int k = node_features.row_offsets[node]; k < node_features.row_offsets[node + 1]; k++)
+            z[o] += node_features.values[k] * W[node_features.col_indices[k] * output_dim + o];
     return z;
 }
 
@@ -74,7 +114,6 @@ vector<vector<float>> GATLayer::forward(
     const vector<vector<int>>& adjacency_list
 ) {
     int n_nodes = node_features.size();
-    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
     vector<vector<float>> z(n_nodes);
 
     // Step 1: Linear transform each node's features
@@ -83,27 +122,344 @@ vector<vector<float>> GATLayer::forward(
     }
 
     // Step 2: Compute attention and aggregate
+    return attend(z, adjacency_list);
+}
+
+// Forward pass over sparse input activations
+vector<vector<float>> GATLayer::forward(
+    const SparseFeatures& node_features,
+    const vector<vector<int>>& adjacency_list
+) {
+    int n_nodes = node_features.num_rows;
+    vector<vector<float>> z(n_nodes);
+
     for (int i = 0; i < n_nodes; i++) {
-        vector<int> neighbors = adjacency_list[i];
-        neighbors.push_back(i); // self-loop
+        z[i] = linear_transform(node_features, i);
+    }
+
+    return attend(z, adjacency_list);
+}
+
+// Attention and aggregation over the projected features
+vector<vector<float>> GATLayer::attend(
+    const vector<vector<float>>& z,
+    const vector<vector<int>>& adjacency_list
+) {
+    int n_nodes = z.size();
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+
+    for (int i = 0; i < n_nodes; i++) {
+        attend_node(i, z, adjacency_list, updated_features[i]);
+    }
+
+    return updated_features;
+}
+
+// Attention and aggregation for one node
+void GATLayer::attend_node(
+    int i,
+    const vector<vector<float>>& z,
+    const vector<vector<int>>& adjacency_list,
+    vector<float>& out_row
+) {
+    vector<int> neighbors = adjacency_list[i];
+    neighbors.push_back(i); // self-loop
+
+    vector<float> e_ij(neighbors.size());
+    for (size_t idx = 0; idx < neighbors.size(); idx++) {
+        int j = neighbors[idx];
+        e_ij[idx] = compute_attention_score(z[i], z[j]);
+    }
 
-        vector<float> e_ij(neighbors.size());
+    vector<float> alpha_ij = softmax(e_ij);
+
+    for (int o = 0; o < output_dim; o++) {
+        float agg = 0.0f;
         for (size_t idx = 0; idx < neighbors.size(); idx++) {
             int j = neighbors[idx];
-            e_ij[idx] = compute_attention_score(z[i], z[j]);
+            agg += alpha_ij[idx] * z[j][o];
         }
+        out_row[o] = relu(agg); // ReLU activation
+    }
+}
+
+// Forward pass restricted to a set of rows. Only the listed rows and their
+// neighbours are projected, into scratch indexed by a compact local id, so the
+// cost follows the rows' neighbourhood rather than the size of the graph
+// (NUMA workers and cache patches call this with small row sets).
+void GATLayer::forward_rows(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& rows,
+    vector<vector<float>>& out
+) {
+    // Step 1: local ids for the listed nodes and their neighbours
+    vector<int> needed(rows.begin(), rows.end());
+    for (int i : rows) {
+        needed.insert(needed.end(), adjacency_list[i].begin(), adjacency_list[i].end());
+    }
+    sort(needed.begin(), needed.end());
+    needed.erase(unique(needed.begin(), needed.end()), needed.end());
+    auto local_id = [&](int node) {
+        return static_cast<int>(lower_bound(needed.begin(), needed.end(), node) - needed.begin());
+    };
+
+    // Step 2: project them once
+    vector<vector<float>> z(needed.size());
+    for (size_t k = 0; k < needed.size(); k++) {
+        z[k] = linear_transform(node_features[needed[k]]);
+    }
+
+    // Step 3: attention and aggregation for the listed nodes over the local ids
+    // (neighbour order is kept, so the result matches forward() exactly)
+    vector<vector<int>> local_adjacency(needed.size());
+    for (int i : rows) {
+        int local = local_id(i);
+        local_adjacency[local].clear();
+        for (int j : adjacency_list[i]) {
+            local_adjacency[local].push_back(local_id(j));
+        }
+        out[i].resize(output_dim);
+        attend_node(local, z, local_adjacency, out[i]);
+    }
+}
+
+// Forward pass over a compressed adjacency
+vector<vector<float>> GATLayer::forward(
+    const vector<vector<float>>& node_features,
+    const CompressedAdjacency& adjacency
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+    vector<vector<float>> z(n_nodes);
+
+    // Step 1: Linear transform each node's features
+    for (int i = 0; i < n_nodes; i++) {
+        z[i] = linear_transform(node_features[i]);
+    }
+
+    // Step 2: Compute attention and aggregate; the self-loop is the last entry
+    vector<float> e_ij;
+    for (int i = 0; i < n_nodes; i++) {
+        e_ij.clear();
+        for (int j : adjacency.neighbors(i)) {
+            e_ij.push_back(compute_attention_score(z[i], z[j]));
+        }
+        e_ij.push_back(compute_attention_score(z[i], z[i]));
 
         vector<float> alpha_ij = softmax(e_ij);
 
+        vector<float>& out = updated_features[i];
+        size_t idx = 0;
+        for (int j : adjacency.neighbors(i)) {
+            for (int o = 0; o < output_dim; o++)
+                out[o] += alpha_ij[idx] * z[j][o];
+            idx++;
+        }
         for (int o = 0; o < output_dim; o++) {
-            float agg = 0.0f;
+            out[o] += alpha_ij[idx] * z[i][o];
+            out[o] = relu(out[o]); // ReLU activation
+        }
+    }
+
+    return updated_features;
+}
+
+// Degree-aware forward pass. The projection is split across workers, light
+// chunks use attend_node, and every hub segment computes a softmax partial
+// over its neighbours (the hub's self-loop rides with its last segment).
+// Partials are combined in a fixed pairwise order, like merge_partial_sums.
+vector<vector<float>> GATLayer::forward_split(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const HubSplitOptions& options
+) {
+    int n_nodes = node_features.size();
+    int num_threads = options.num_threads > 0 ? options.num_threads : default_thread_count();
+    HubSplitPlan plan = plan_hub_split(adjacency_list, options);
+
+    vector<vector<float>> z(n_nodes);
+    parallel_for(0, n_nodes, num_threads, [&](long long begin, long long end, int) {
+        for (long long i = begin; i < end; i++) {
+            z[i] = linear_transform(node_features[i]);
+        }
+    });
+
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+    vector<SoftmaxPartial> partial(plan.segments.size());
+
+    run_hub_split(plan, num_threads,
+        [&](const vector<int>& rows) {
+            for (int i : rows) {
+                attend_node(i, z, adjacency_list, updated_features[i]);
+            }
+        },
+        [&](size_t s) {
+            const HubSplitPlan::Segment& segment = plan.segments[s];
+            int i = segment.node;
+            vector<int> neighbors(adjacency_list[i].begin() + segment.begin,
+                                  adjacency_list[i].begin() + segment.end);
+            if (segment.end == static_cast<int>(adjacency_list[i].size())) {
+                neighbors.push_back(i); // self-loop
+            }
+
+            vector<float> e_ij(neighbors.size());
             for (size_t idx = 0; idx < neighbors.size(); idx++) {
-                int j = neighbors[idx];
-                agg += alpha_ij[idx] * z[j][o];
+                e_ij[idx] = compute_attention_score(z[i], z[neighbors[idx]]);
             }
-            updated_features[i][o] = relu(agg); // ReLU activation
-        }
+
+            SoftmaxPartial& state = partial[s];
+            state.max_score = *max_element(e_ij.begin(), e_ij.end());
+            state.weighted.assign(output_dim, 0.0f);
+            for (size_t idx = 0; idx < neighbors.size(); idx++) {
+                float weight = exp(e_ij[idx] - state.max_score);
+                state.sum_exp += weight;
+                const vector<float>& z_j = z[neighbors[idx]];
+                for (int o = 0; o < output_dim; o++) {
+                    state.weighted[o] += weight * z_j[o];
+                }
+            }
+        },
+        [&](size_t h) {
+            int first = plan.hub_segment_begin[h];
+            int count = plan.hub_segment_begin[h + 1] - first;
+            for (int stride = 1; stride < count; stride *= 2) {
+                for (int k = 0; k + stride < count; k += 2 * stride) {
+                    merge_softmax(partial[first + k], partial[first + k + stride]);
+                }
+            }
+            const SoftmaxPartial& state = partial[first];
+            vector<float>& out_row = updated_features[plan.hubs[h]];
+            for (int o = 0; o < output_dim; o++) {
+                out_row[o] = relu(state.weighted[o] / state.sum_exp); // ReLU activation
+            }
+        });
+
+    return updated_features;
+}
+
+// Gradient buffers, allocated on first use
+vector<vector<float>*> GATLayer::gradients() {
+    W_grad.resize(W.size(), 0.0f);
+    a_grad.resize(a.size(), 0.0f);
+    return {&W_grad, &a_grad};
+}
+
+// Training forward pass
+vector<vector<float>> GATLayer::forward_train(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    bool keep_intermediates
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> z(n_nodes);
+    for (int i = 0; i < n_nodes; i++) {
+        z[i] = linear_transform(node_features[i]);
     }
 
+    vector<vector<float>> updated_features = attend(z, adjacency_list);
+    if (keep_intermediates) {
+        stored_z = std::move(z);
+    } else {
+        stored_z.clear(); // never let backward() pick up an older step's z
+    }
     return updated_features;
 }
+
+// Backward pass
+vector<vector<float>> GATLayer::backward(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<vector<float>>& output,
+    const vector<vector<float>>& grad_output
+) {
+    int n_nodes = node_features.size();
+    if (!stored_z.empty() && static_cast<int>(stored_z.size()) != n_nodes) {
+        throw logic_error("GATLayer::backward: stored z does not match the layer input");
+    }
+    vector<vector<float>> z;
+    if (stored_z.empty()) {
+        z.resize(n_nodes);
+        for (int i = 0; i < n_nodes; i++) {
+            z[i] = linear_transform(node_features[i]);
+        }
+    } else {
+        z = std::move(stored_z);
+    }
+    stored_z.clear();
+    gradients();
+
+    // Step 1: gradients of z, node by node (the self-loop is the last entry)
+    vector<vector<float>> grad_z(n_nodes, vector<float>(output_dim, 0.0f));
+    vector<float> grad_pre(output_dim);
+    vector<int> neighbors;
+    vector<float> raw_scores, e_ij, grad_alpha;
+    for (int i = 0; i < n_nodes; i++) {
+        for (int o = 0; o < output_dim; o++) {
+            grad_pre[o] = output[i][o] > 0.0f ? grad_output[i][o] : 0.0f;
+        }
+
+        neighbors = adjacency_list[i];
+        neighbors.push_back(i);
+        size_t count = neighbors.size();
+
+        raw_scores.resize(count);
+        e_ij.resize(count);
+        for (size_t idx = 0; idx < count; idx++) {
+            int j = neighbors[idx];
+            float score = 0.0f;
+            for (int o = 0; o < output_dim; o++) {
+                score += a[o] * z[i][o] + a[o + output_dim] * z[j][o];
+            }
+            raw_scores[idx] = score;
+            e_ij[idx] = leaky_relu(score);
+        }
+        vector<float> alpha_ij = softmax(e_ij);
+
+        // weighted sum: out_i = sum_j alpha_ij z_j
+        grad_alpha.resize(count);
+        float weighted = 0.0f;
+        for (size_t idx = 0; idx < count; idx++) {
+            int j = neighbors[idx];
+            float g = 0.0f;
+            for (int o = 0; o < output_dim; o++) {
+                g += grad_pre[o] * z[j][o];
+                grad_z[j][o] += alpha_ij[idx] * grad_pre[o];
+            }
+            grad_alpha[idx] = g;
+            weighted += alpha_ij[idx] * g;
+        }
+
+        // softmax, LeakyReLU and the score a^T [z_i, z_j]
+        for (size_t idx = 0; idx < count; idx++) {
+            int j = neighbors[idx];
+            float grad_e = alpha_ij[idx] * (grad_alpha[idx] - weighted);
+            float grad_score = raw_scores[idx] > 0 ? grad_e : 0.2f * grad_e;
+            if (grad_score == 0.0f) continue;
+            for (int o = 0; o < output_dim; o++) {
+                a_grad[o] += grad_score * z[i][o];
+                a_grad[o + output_dim] += grad_score * z[j][o];
+                grad_z[i][o] += grad_score * a[o];
+                grad_z[j][o] += grad_score * a[o + output_dim];
+            }
+        }
+    }
+
+    // Step 2: projection z = x W
+    vector<vector<float>> grad_input(n_nodes, vector<float>(input_dim, 0.0f));
+    for (int i = 0; i < n_nodes; i++) {
+        const vector<float>& dz = grad_z[i];
+        for (int d = 0; d < input_dim; d++) {
+            float x = node_features[i][d];
+            const float* w = W.data() + d * output_dim;
+            float* g = W_grad.data() + d * output_dim;
+            float sum = 0.0f;
+            for (int o = 0; o < output_dim; o++) {
+                g[o] += x * dz[o];
+                sum += w[o] * dz[o];
+            }
+            grad_input[i][d] = sum;
+        }
+    }
+    return grad_input;
+}
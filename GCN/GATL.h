@@ -1,6 +1,7 @@
 // GATL.h
 #pragma once
 #include "BaseLayer.h"
+#include <cstdint>
 #include <vector>
 using namespace std;
 
@@ -10,13 +11,26 @@ using namespace std;
 class GATLayer : public BaseLayer {
 public:
     int input_dim, output_dim;  // Input and output dimension
-    vector<vector<float>> W;    // Weight matrix for linear transformation
+    vector<float> W;            // Weight matrix for linear transformation, row-major [input_dim * output_dim]
     vector<float> a;            // Attention vector used for computing attention coefficients
 
     // Constructor initializes the GAT layer with input and output dimensions
     // and performs Xavier initialization for weights and attention parameters.
     GATLayer(int input_dim, int output_dim);
 
+    // Same Xavier initialisation drawn from a fixed seed, so the parameters are reproducible
+    GATLayer(int input_dim, int output_dim, uint64_t seed);
+
+    // Uses existing parameters (e.g. from a checkpoint):
+    // W row-major [input_dim * output_dim] and a [2 * output_dim]
+    GATLayer(int input_dim, int output_dim, vector<float> W, vector<float> a);
+
+    int get_input_dim() const override { return input_dim; }
+    int get_output_dim() const override { return output_dim; }
+    string type_name() const override { return "gat"; }
+    vector<vector<float>*> parameters() override { return {&W, &a}; }
+    vector<vector<float>*> gradients() override;
+
     // Forward pass computes the updated node features based on attention mechanism.
     // It projects input features, computes attention scores with neighbours, applies softmax,
     // aggregates neighbour features weighted by attention, and applies ReLU.
@@ -25,7 +39,63 @@ public:
         const vector<vector<int>>& adjacency_list   // represents the graph
     ) override;
 
+    // Attention forward pass restricted to the listed nodes. Only the listed
+    // nodes and their neighbours are projected.
+    void forward_rows(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const vector<int>& rows,                    // nodes to compute
+        vector<vector<float>>& out                  // output matrix, rows written in place
+    ) override;
+
+    // Same attention forward pass, decoding neighbour lists on the fly.
+    // Each list is walked twice (scores, then weighted sum) instead of being copied.
+    vector<vector<float>> forward(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const CompressedAdjacency& adjacency        // compressed graph structure
+    ) override;
+
+    // Same forward pass over sparse input activations; the projection of each
+    // node only touches the weight rows of its non-zero features.
+    vector<vector<float>> forward(
+        const SparseFeatures& node_features,        // sparse node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list   // represents the graph
+    ) override;
+
+    // Degree-aware forward pass: the projection runs in parallel, a hub's
+    // neighbours are attended in segments that each keep only a running max,
+    // sum of exponentials and weighted sum (online softmax), merged with the
+    // log-sum-exp rule, so no per-node score vector grows with the degree
+    vector<vector<float>> forward_split(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const HubSplitOptions& options              // threshold, segment size, workers
+    ) override;
+
+    // Training forward pass; keeps the projected features z for backward() if
+    // asked to. Attention coefficients are always recomputed from z, which costs
+    // one score per edge instead of storing them.
+    vector<vector<float>> forward_train(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        bool keep_intermediates                     // store z instead of recomputing it
+    ) override;
+
+    // Backward pass through the weighted sum, the softmax, the LeakyReLU scores
+    // and the projection. Gradients for z are scattered along each node's
+    // neighbour list (plus self-loop), then dW = X^T dz and dX = dz W^T.
+    vector<vector<float>> backward(
+        const vector<vector<float>>& node_features, // layer input
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const vector<vector<float>>& output,        // result of forward_train
+        const vector<vector<float>>& grad_output    // dLoss/dOutput
+    ) override;
+
 private:
+    vector<float> W_grad;            // gradient of W, filled by backward
+    vector<float> a_grad;            // gradient of a, filled by backward
+    vector<vector<float>> stored_z;  // projected features kept by forward_train for backward
+
     // Applies ReLU activation to a single float value
     float relu(float x);
 
@@ -37,6 +107,27 @@ private:
         const vector<float>& features // Input feature vector of a node
     );
 
+    // Same transformation for a sparse feature row (non-zeros only)
+    vector<float> linear_transform(
+        const SparseFeatures& node_features, // sparse feature matrix
+        int node                             // row to transform
+    );
+
+    // Computes attention coefficients over each node's neighbours (plus self-loop)
+    // from the projected features z and aggregates them, followed by ReLU
+    vector<vector<float>> attend(
+        const vector<vector<float>>& z,           // projected features:[number of nodes][output_dim]
+        const vector<vector<int>>& adjacency_list // represents the graph
+    );
+
+    // Attention and aggregation for a single node, written into out_row
+    void attend_node(
+        int i,                                    // centre node
+        const vector<vector<float>>& z,           // projected features:[number of nodes][output_dim]
+        const vector<vector<int>>& adjacency_list, // represents the graph
+        vector<float>& out_row                    // output row of node i (size output_dim)
+    );
+
     // Computes attention score (unnormalised) for node i and node j
     // using attention vector applied to concatenation of projected features of node i and node j
     float compute_attention_score(
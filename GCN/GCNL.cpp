@@ -1,20 +1,28 @@
 // GCNL.cpp
 
 #include "GCNL.h"
-#include <random>
+#include "WeightInit.h"
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 // Xavier Initialization
-GCNLayer::GCNLayer(int input_dim, int output_dim) : input_dim(input_dim), output_dim(output_dim) {
-    weight_matrix.resize(input_dim, vector<float>(output_dim));
+GCNLayer::GCNLayer(int input_dim, int output_dim)
+    : GCNLayer(input_dim, output_dim, random_seed()) {}
+
+// Xavier Initialization from a fixed seed
+GCNLayer::GCNLayer(int input_dim, int output_dim, uint64_t seed) : input_dim(input_dim), output_dim(output_dim) {
+    weight_matrix.resize(input_dim * output_dim);
     float limit = sqrt(6.0f / (input_dim + output_dim));
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<> dis(0, limit);
-    for (int i = 0; i < input_dim; i++)
-        for (int j = 0; j < output_dim; j++)
-            weight_matrix[i][j] = dis(gen);
+    init_uniform(weight_matrix, 0.0f, limit, seed);
+}
+
+// Existing packed weights
+GCNLayer::GCNLayer(int input_dim, int output_dim, vector<float> weights)
+    : input_dim(input_dim), output_dim(output_dim), weight_matrix(std::move(weights)) {
+    if (weight_matrix.size() != static_cast<size_t>(input_dim) * output_dim) {
+        throw invalid_argument("GCNLayer: weight matrix size does not match dimensions");
+    }
 }
 
 // ReLU activation
@@ -22,16 +30,16 @@ float GCNLayer::relu(float x) {
     return max(0.0f, x);
 }
 
-// Aggregates normalized neighbor features for a node
+// Aggregates normalized neighbor features, decoding the neighbor list on the fly
 vector<float> GCNLayer::aggregate_neighbors(
     int node,
     const vector<vector<float>>& node_features,
-    const vector<vector<int>>& adjacency_list,
+    const CompressedAdjacency& adjacency,
     const vector<int>& degrees
 ) {
     vector<float> aggregated(input_dim, 0.0f);
-    for (int neighbor : adjacency_list[node]) {
-        float normalization = sqrt(degrees[node] * degrees[neighbor]);
+    for (int neighbor : adjacency.neighbors(node)) {
+        float normalization = sqrt(static_cast<double>(degrees[node]) * degrees[neighbor]);
         if (normalization != 0.0f) {
             for (int d = 0; d < input_dim; d++) {
                 aggregated[d] += node_features[neighbor][d] / normalization;
@@ -41,6 +49,55 @@ vector<float> GCNLayer::aggregate_neighbors(
     return aggregated;
 }
 
+// Aggregates one feature chunk of a tile of nodes into the scratch block
+void GCNLayer::aggregate_tile(
+    const int* tile_rows, int tile_size,
+    int chunk_begin, int width,
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const int* degrees,
+    float* block
+) {
+    for (int t = 0; t < tile_size; t++) {
+        int i = tile_rows[t];
+        int degree = degrees ? degrees[i] : static_cast<int>(adjacency_list[i].size());
+        float* row = block + t * kFeatureChunk;
+        fill(row, row + width, 0.0f);
+        for (int neighbor : adjacency_list[i]) {
+            int neighbor_degree = degrees ? degrees[neighbor] : static_cast<int>(adjacency_list[neighbor].size());
+            float normalization = sqrt(static_cast<double>(degree) * neighbor_degree);
+            if (normalization != 0.0f) {
+                const float* x = node_features[neighbor].data() + chunk_begin;
+                for (int d = 0; d < width; d++) {
+                    row[d] += x[d] / normalization;
+                }
+            }
+        }
+    }
+}
+
+// Multiplies the aggregated block into the tile accumulators.
+// Each output is still accumulated over input dimensions in ascending order,
+// so the result matches the per-node aggregate + linear_transform path exactly.
+void GCNLayer::transform_tile(
+    int tile_size,
+    int chunk_begin, int width,
+    const float* block,
+    float* accumulators
+) {
+    for (int t = 0; t < tile_size; t++) {
+        const float* row = block + t * kFeatureChunk;
+        float* out = accumulators + t * output_dim;
+        for (int d = 0; d < width; d++) {
+            float a = row[d];
+            const float* w = weight_matrix.data() + (chunk_begin + d) * output_dim;
+            for (int o = 0; o < output_dim; o++) {
+                out[o] += a * w[o];
+            }
+        }
+    }
+}
+
 // Applies weight matrix for a given output dimension
 float GCNLayer::linear_transform(
     const vector<float>& aggregated_features,
@@ -48,7 +105,7 @@ float GCNLayer::linear_transform(
 ) {
     float val = 0.0f;
     for (int d = 0; d < input_dim; d++) {
-        val += aggregated_features[d] * weight_matrix[d][output_index];
+        val += aggregated_features[d] * weight_matrix[d * output_dim + output_index];
     }
     return val;
 }
@@ -61,14 +118,84 @@ vector<vector<float>> GCNLayer::forward(
     int n_nodes = node_features.size();
     vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
 
-    // Precompute degrees
+    vector<int> rows(n_nodes);
+    for (int i = 0; i < n_nodes; i++) {
+        rows[i] = i;
+    }
+    forward_rows(node_features, adjacency_list, rows, updated_features);
+
+    return updated_features;
+}
+
+void GCNLayer::forward_rows(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& rows,
+    vector<vector<float>>& out
+) {
+    fused_rows(node_features, adjacency_list, nullptr, rows, out);
+}
+
+void GCNLayer::forward_local_rows(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& degrees,
+    const vector<int>& rows,
+    vector<vector<float>>& out
+) {
+    fused_rows(node_features, adjacency_list, degrees.data(), rows, out);
+}
+
+// Fused aggregate -> transform -> ReLU, one tile of destination nodes at a time.
+// Aggregates never leave the L1 block; only the finished rows are written out.
+void GCNLayer::fused_rows(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const int* degrees,
+    const vector<int>& rows,
+    vector<vector<float>>& out
+) {
+    int n_rows = rows.size();
+    vector<float> block(kTileNodes * kFeatureChunk);
+    vector<float> accumulators(kTileNodes * output_dim);
+    for (int tile_begin = 0; tile_begin < n_rows; tile_begin += kTileNodes) {
+        const int* tile_rows = rows.data() + tile_begin;
+        int tile_size = min(kTileNodes, n_rows - tile_begin);
+        fill(accumulators.begin(), accumulators.end(), 0.0f);
+
+        for (int chunk_begin = 0; chunk_begin < input_dim; chunk_begin += kFeatureChunk) {
+            int width = min(kFeatureChunk, input_dim - chunk_begin);
+            aggregate_tile(tile_rows, tile_size, chunk_begin, width,
+                           node_features, adjacency_list, degrees, block.data());
+            transform_tile(tile_size, chunk_begin, width, block.data(), accumulators.data());
+        }
+
+        for (int t = 0; t < tile_size; t++) {
+            const float* acc = accumulators.data() + t * output_dim;
+            vector<float>& out_row = out[tile_rows[t]];
+            out_row.resize(output_dim);
+            for (int o = 0; o < output_dim; o++) {
+                out_row[o] = relu(acc[o]);
+            }
+        }
+    }
+}
+
+// Forward pass for GCN Layer over a compressed adjacency
+vector<vector<float>> GCNLayer::forward(
+    const vector<vector<float>>& node_features,
+    const CompressedAdjacency& adjacency
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+
     vector<int> degrees(n_nodes);
     for (int i = 0; i < n_nodes; i++) {
-        degrees[i] = adjacency_list[i].size();
+        degrees[i] = adjacency.degree(i);
     }
 
     for (int i = 0; i < n_nodes; i++) {
-        vector<float> aggregated = aggregate_neighbors(i, node_features, adjacency_list, degrees);
+        vector<float> aggregated = aggregate_neighbors(i, node_features, adjacency, degrees);
         for (int o = 0; o < output_dim; o++) {
             float val = linear_transform(aggregated, o);
             updated_features[i][o] = relu(val);
@@ -77,3 +204,195 @@ vector<vector<float>> GCNLayer::forward(
 
     return updated_features;
 }
+
+// Forward pass for GCN Layer over sparse input activations.
+// Zero inputs contribute exact zeros in the dense pass, so skipping them
+// leaves every sum (and its accumulation order) unchanged.
+vector<vector<float>> GCNLayer::forward(
+    const SparseFeatures& node_features,
+    const vector<vector<int>>& adjacency_list
+) {
+    int n_nodes = node_features.num_rows;
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+
+    vector<int> degrees(n_nodes);
+    for (int i = 0; i < n_nodes; i++) {
+        degrees[i] = adjacency_list[i].size();
+    }
+
+    vector<float> aggregated(input_dim);
+    for (int i = 0; i < n_nodes; i++) {
+        fill(aggregated.begin(), aggregated.end(), 0.0f);
+        for (int neighbor : adjacency_list[i]) {
+            float normalization = sqrt(static_cast<double>(degrees[i]) * degrees[neighbor]);
+            if (normalization != 0.0f) {
+                for (int k = node_features.row_offsets[neighbor]; k < node_features.row_offsets[neighbor + 1]; k++) {
+                    aggregated[node_features.col_indices[k]] += node_features.values[k] / normalization;
+                }
+            }
+        }
+
+        vector<float>& out = updated_features[i];
+        for (int d = 0; d < input_dim; d++) {
+            float a = aggregated[d];
+            if (a == 0.0f) continue;
+            const float* w = weight_matrix.data() + d * output_dim;
+            for (int o = 0; o < output_dim; o++) {
+                out[o] += a * w[o];
+            }
+        }
+        for (int o = 0; o < output_dim; o++) {
+            out[o] = relu(out[o]);
+        }
+    }
+
+    return updated_features;
+}
+
+// Degree-aware forward pass for GCN Layer. Light chunks go through the fused
+// tile kernel; each hub segment sums its share of the normalized neighbours,
+// and the merged sum is transformed like any other aggregate.
+vector<vector<float>> GCNLayer::forward_split(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const HubSplitOptions& options
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+    HubSplitPlan plan = plan_hub_split(adjacency_list, options);
+    vector<vector<float>> partial(plan.segments.size());
+
+    run_hub_split(plan, options.num_threads,
+        [&](const vector<int>& rows) {
+            forward_rows(node_features, adjacency_list, rows, updated_features);
+        },
+        [&](size_t s) {
+            const HubSplitPlan::Segment& segment = plan.segments[s];
+            const vector<int>& neighbors = adjacency_list[segment.node];
+            int degree = neighbors.size();
+            vector<float>& sum = partial[s];
+            sum.assign(input_dim, 0.0f);
+            for (int k = segment.begin; k < segment.end; k++) {
+                int neighbor = neighbors[k];
+                float normalization = sqrt(static_cast<double>(degree) * adjacency_list[neighbor].size());
+                if (normalization != 0.0f) {
+                    for (int d = 0; d < input_dim; d++) {
+                        sum[d] += node_features[neighbor][d] / normalization;
+                    }
+                }
+            }
+        },
+        [&](size_t h) {
+            int first = plan.hub_segment_begin[h];
+            merge_partial_sums(partial.data() + first, plan.hub_segment_begin[h + 1] - first);
+            vector<float>& out_row = updated_features[plan.hubs[h]];
+            for (int o = 0; o < output_dim; o++) {
+                out_row[o] = relu(linear_transform(partial[first], o));
+            }
+        });
+
+    return updated_features;
+}
+
+// Gradient buffer, allocated on first use
+vector<vector<float>*> GCNLayer::gradients() {
+    weight_grad.resize(weight_matrix.size(), 0.0f);
+    return {&weight_grad};
+}
+
+// Normalized neighbor aggregation of all nodes, in the same order as aggregate_tile
+vector<vector<float>> GCNLayer::aggregate_all(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> aggregated(n_nodes, vector<float>(input_dim, 0.0f));
+    for (int i = 0; i < n_nodes; i++) {
+        int degree = adjacency_list[i].size();
+        for (int neighbor : adjacency_list[i]) {
+            float normalization = sqrt(static_cast<double>(degree) * adjacency_list[neighbor].size());
+            if (normalization != 0.0f) {
+                for (int d = 0; d < input_dim; d++) {
+                    aggregated[i][d] += node_features[neighbor][d] / normalization;
+                }
+            }
+        }
+    }
+    return aggregated;
+}
+
+// Training forward pass for GCN Layer
+vector<vector<float>> GCNLayer::forward_train(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    bool keep_intermediates
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> aggregated = aggregate_all(node_features, adjacency_list);
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+    for (int i = 0; i < n_nodes; i++) {
+        for (int o = 0; o < output_dim; o++) {
+            updated_features[i][o] = relu(linear_transform(aggregated[i], o));
+        }
+    }
+
+    if (keep_intermediates) {
+        stored_aggregates = std::move(aggregated);
+    } else {
+        stored_aggregates.clear(); // never let backward() pick up an older step's aggregates
+    }
+    return updated_features;
+}
+
+// Backward pass for GCN Layer.
+// The aggregation is symmetric in its normalisation, so its transpose walks the
+// same neighbour lists: node i sends grad_aggregate_i / sqrt(d_i d_j) to each neighbor j.
+vector<vector<float>> GCNLayer::backward(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<vector<float>>& output,
+    const vector<vector<float>>& grad_output
+) {
+    int n_nodes = node_features.size();
+    if (!stored_aggregates.empty() && static_cast<int>(stored_aggregates.size()) != n_nodes) {
+        throw logic_error("GCNLayer::backward: stored aggregates do not match the layer input");
+    }
+    vector<vector<float>> aggregated = stored_aggregates.empty()
+        ? aggregate_all(node_features, adjacency_list)
+        : std::move(stored_aggregates);
+    stored_aggregates.clear();
+    gradients();
+
+    vector<vector<float>> grad_input(n_nodes, vector<float>(input_dim, 0.0f));
+    vector<float> grad_pre(output_dim);       // gradient before the ReLU
+    vector<float> grad_aggregate(input_dim);  // gradient of the node's aggregate
+    for (int i = 0; i < n_nodes; i++) {
+        for (int o = 0; o < output_dim; o++) {
+            grad_pre[o] = output[i][o] > 0.0f ? grad_output[i][o] : 0.0f;
+        }
+
+        for (int d = 0; d < input_dim; d++) {
+            float a = aggregated[i][d];
+            const float* w = weight_matrix.data() + d * output_dim;
+            float* g = weight_grad.data() + d * output_dim;
+            float sum = 0.0f;
+            for (int o = 0; o < output_dim; o++) {
+                g[o] += a * grad_pre[o];
+                sum += w[o] * grad_pre[o];
+            }
+            grad_aggregate[d] = sum;
+        }
+
+        int degree = adjacency_list[i].size();
+        for (int neighbor : adjacency_list[i]) {
+            float normalization = sqrt(static_cast<double>(degree) * adjacency_list[neighbor].size());
+            if (normalization != 0.0f) {
+                vector<float>& target = grad_input[neighbor];
+                for (int d = 0; d < input_dim; d++) {
+                    target[d] += grad_aggregate[d] / normalization;
+                }
+            }
+        }
+    }
+    return grad_input;
+}
@@ -2,6 +2,7 @@
 
 #pragma once
 #include "BaseLayer.h"
+#include <cstdint>
 #include <vector>
 using namespace std;
 
@@ -13,30 +14,142 @@ public:
     // performs Xavier initialisation of weight matrix.
     GCNLayer(int input_dim, int output_dim);
 
+    // Same Xavier initialisation drawn from a fixed seed, so the weights are reproducible
+    GCNLayer(int input_dim, int output_dim, uint64_t seed);
+
+    // Uses existing packed weights, row-major [input_dim * output_dim] (e.g. from a checkpoint)
+    GCNLayer(int input_dim, int output_dim, vector<float> weights);
+
+    int get_input_dim() const override { return input_dim; }
+    int get_output_dim() const override { return output_dim; }
+    string type_name() const override { return "gcn"; }
+    vector<vector<float>*> parameters() override { return {&weight_matrix}; }
+    vector<vector<float>*> gradients() override;
+
     // forward pass computes the updated node features 
-    // using the input features and the adjacency list
+    // using the input features and the adjacency list.
+    // Aggregation, transformation and ReLU are fused per tile of kTileNodes nodes.
+    vector<vector<float>> forward(
+        const vector<vector<float>>& node_features, // feature matrix-[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list // represents graph structure
+    ) override;
+
+    // fused forward pass restricted to the listed destination nodes
+    void forward_rows(
+        const vector<vector<float>>& node_features, // feature matrix-[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents graph structure
+        const vector<int>& rows,                    // destination nodes to compute
+        vector<vector<float>>& out                  // output matrix, rows written in place
+    ) override;
+
+    // fused forward pass over a local view of a larger graph: the
+    // normalisation takes every node's degree from 'degrees'
+    void forward_local_rows(
+        const vector<vector<float>>& node_features, // feature matrix-[number of local nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // local lists (complete for the listed rows)
+        const vector<int>& degrees,                 // true degree of every local node
+        const vector<int>& rows,                    // destination nodes to compute
+        vector<vector<float>>& out                  // output matrix, rows written in place
+    ) override;
+
+    // same forward pass, decoding neighbour lists on the fly
     vector<vector<float>> forward(
         const vector<vector<float>>& node_features, // feature matrix-[number of nodes][input_dim]
+        const CompressedAdjacency& adjacency        // compressed graph structure
+    ) override;
+
+    // same forward pass over sparse input activations: only stored non-zeros
+    // are aggregated and zero aggregates are skipped in the projection
+    vector<vector<float>> forward(
+        const SparseFeatures& node_features,      // sparse feature matrix-[number of nodes][input_dim]
         const vector<vector<int>>& adjacency_list // represents graph structure
     ) override;
 
+    // degree-aware forward pass: hub nodes are aggregated in segments
+    // by different workers and their partial sums merged pairwise
+    vector<vector<float>> forward_split(
+        const vector<vector<float>>& node_features, // feature matrix-[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents graph structure
+        const HubSplitOptions& options              // threshold, segment size, workers
+    ) override;
+
+    // training forward pass: aggregates all nodes, then transforms;
+    // keeps the aggregates for backward() if asked to
+    vector<vector<float>> forward_train(
+        const vector<vector<float>>& node_features, // feature matrix-[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents graph structure
+        bool keep_intermediates                     // store aggregates instead of recomputing them
+    ) override;
+
+    // backward pass: dW = aggregates^T * dOut, and the input gradient is the
+    // transposed aggregation of dOut * W^T, scattered along the same neighbour
+    // lists with the same normalisation
+    vector<vector<float>> backward(
+        const vector<vector<float>>& node_features, // layer input
+        const vector<vector<int>>& adjacency_list,  // represents graph structure
+        const vector<vector<float>>& output,        // result of forward_train
+        const vector<vector<float>>& grad_output    // dLoss/dOutput
+    ) override;
+
 private:
+    static constexpr int kTileNodes = 16;     // destination nodes processed together
+    static constexpr int kFeatureChunk = 256; // input dimensions per block (keeps the weight panel in L2)
+
     int input_dim;              // dimension of input features
     int output_dim;             // dimension of output features
-    vector<vector<float>> weight_matrix; // weight matrix of shape [input_dim][output_dim]
+    vector<float> weight_matrix; // packed weight panel, row-major [input_dim * output_dim]
+    vector<float> weight_grad;   // gradient of weight_matrix (same layout), filled by backward
+    vector<vector<float>> stored_aggregates; // aggregates kept by forward_train for backward
     
     float relu(float x); // Applies ReLU function to a single value (Activation function)
 
     // Aggregates normalised neighbour features for a given node.
     // Each neighbour's features are first scaled down by the inverse of
     // the product of degrees of node and the neighbour, ensuring normalisation.
+    // (used by the compressed-adjacency path; the plain path aggregates per tile)
     vector<float> aggregate_neighbors(
         int node,                                   // the centre node
         const vector<vector<float>>& node_features, // Feature matrix of nodes
-        const vector<vector<int>>& adjacency_list,  // graph adjacency list
+        const CompressedAdjacency& adjacency,       // compressed graph adjacency
         const vector<int>& degrees                  // pre-computed degrees of each node
     );
 
+    // Normalised neighbour aggregates of every node:[number of nodes][input_dim]
+    vector<vector<float>> aggregate_all(
+        const vector<vector<float>>& node_features, // Feature matrix of nodes
+        const vector<vector<int>>& adjacency_list   // graph adjacency list
+    );
+
+    // Shared body of forward_rows and forward_local_rows
+    void fused_rows(
+        const vector<vector<float>>& node_features, // Feature matrix of nodes
+        const vector<vector<int>>& adjacency_list,  // graph adjacency list
+        const int* degrees,                         // degree of every node, or null to use the list sizes
+        const vector<int>& rows,                    // destination nodes to compute
+        vector<vector<float>>& out                  // output matrix, rows written in place
+    );
+
+    // Aggregates input dimensions [chunk_begin, chunk_begin + width) of the
+    // normalised neighbour features of the tile's nodes into 'block',
+    // a [kTileNodes][kFeatureChunk] scratch area small enough to stay in L1.
+    void aggregate_tile(
+        const int* tile_rows, int tile_size,        // destination nodes of the tile
+        int chunk_begin, int width,                 // input dimensions of the chunk
+        const vector<vector<float>>& node_features, // Feature matrix of nodes
+        const vector<vector<int>>& adjacency_list,  // graph adjacency list
+        const int* degrees,                         // degree of every node, or null to use the list sizes
+        float* block                                // output block
+    );
+
+    // Multiplies the aggregated block by weight rows [chunk_begin, chunk_begin + width)
+    // and adds the result to the tile's accumulators ([tile_size][output_dim])
+    void transform_tile(
+        int tile_size,
+        int chunk_begin, int width,
+        const float* block,
+        float* accumulators
+    );
+
     // Applies weight matrix to the aggregated neighbour features to compute
     // the output for a single output dimension
     float linear_transform(
@@ -24,7 +24,7 @@ vector<float> GCNTestLayer::aggregate_neighbors(
 ) {
     vector<float> aggregated(input_dim, 0.0f);
     for (int neighbor : adjacency_list[node]) {
-        float normalization = sqrt(degrees[node] * degrees[neighbor]);
+        float normalization = sqrt(static_cast<double>(degrees[node]) * degrees[neighbor]);
         if (normalization != 0.0f) {
             for (int d = 0; d < input_dim; d++) {
                 aggregated[d] += node_features[neighbor][d] / normalization;
@@ -13,6 +13,9 @@ public:
     // performs Xavier initialisation of weight matrix.
     GCNTestLayer(int input_dim, int output_dim);
 
+    int get_input_dim() const override { return input_dim; }
+    int get_output_dim() const override { return output_dim; }
+
     // forward pass computes the updated node features 
     // using the input features and the adjacency list
     vector<vector<float>> forward(
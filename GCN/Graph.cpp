@@ -1,7 +1,15 @@
 #include "Graph.h"
+#include <atomic>
+
+namespace {
+
+// source of Graph::id
+atomic<uint64_t> next_graph_id{1};
+
+}  // namespace
 
 Graph::Graph(int num_nodes, int num_node_features)
-    : num_nodes(num_nodes), num_node_features(num_node_features)
+    : num_nodes(num_nodes), num_node_features(num_node_features), id(next_graph_id++)
 {
     node_features.resize(num_nodes, vector<float>(num_node_features, 0.0f));
     adjacency_list.resize(num_nodes);
@@ -14,7 +22,9 @@ Graph::Graph(Graph&& other) noexcept
       adjacency_list(std::move(other.adjacency_list)),
       edge_features(std::move(other.edge_features)),
       global_features(std::move(other.global_features)),
-      edge_list(std::move(other.edge_list))  // Added
+      edge_list(std::move(other.edge_list)),  // Added
+      id(other.id),
+      version(other.version)
 {}
 
 Graph& Graph::operator=(Graph&& other) noexcept {
@@ -26,6 +36,8 @@ Graph& Graph::operator=(Graph&& other) noexcept {
         edge_features = std::move(other.edge_features);
         global_features = std::move(other.global_features);
         edge_list = std::move(other.edge_list);  // Added
+        id = other.id;
+        version = other.version;
     }
     return *this;
 }
@@ -35,11 +47,13 @@ void Graph::add_edge(int src, int dst) {
     // If undirected:
     adjacency_list[dst].push_back(src);
     edge_list.emplace_back(src, dst);  // Added
+    version++;
 }
 
 void Graph::set_node_feature(int node_id, const vector<float>& features) {
     if (features.size() == num_node_features) {
         node_features[node_id] = features;
+        version++;
     }
     // Otherwise, throw or handle mismatch
 }
@@ -1,6 +1,7 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <cstdint>
 #include <vector>
 using namespace std;
 
@@ -22,6 +23,14 @@ public:
     // New addition: stores (src, dst) for every edge added
     vector<pair<int, int>> edge_list;
 
+    // Identity for caches: 'id' is unique per graph built in this process and
+    // 'version' goes up on every change made through add_edge / set_node_feature.
+    // Writes straight to node_features / adjacency_list do not change it: call
+    // touch() after them, or EmbeddingCache (unless keyed on content) serves
+    // outputs of the old graph.
+    uint64_t id;
+    uint64_t version = 0;
+
     // Constructs a graph with the specified number of nodes and node feature dimensions.
     // Initializes empty adjacency list and zero-initialized feature matrices.
     Graph(int num_nodes, int num_node_features);
@@ -40,6 +49,9 @@ public:
 
     // New accessor: returns the src and dst for a given edge ID
     pair<int, int> edge(size_t edge_id) const;
+
+    // Marks the graph as changed (bumps 'version')
+    void touch() { version++; }
 };
 
 #endif
@@ -0,0 +1,169 @@
+// GraphBuilder.cpp
+
+#include "GraphBuilder.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void GraphBuilder::Writer::add_edge(int src, int dst) {
+    int n_nodes = builder->num_nodes;
+    if (src < 0 || src >= n_nodes || dst < 0 || dst >= n_nodes) {
+        throw out_of_range("GraphBuilder: edge (" + to_string(src) + ", " + to_string(dst)
+                           + ") references a node outside [0, " + to_string(n_nodes) + ")");
+    }
+    edges->emplace_back(src, dst);
+    builder->degree[src].fetch_add(1, memory_order_relaxed);
+    builder->degree[dst].fetch_add(1, memory_order_relaxed);
+}
+
+void GraphBuilder::Writer::reserve(size_t count) {
+    edges->reserve(edges->size() + count);
+}
+
+GraphBuilder::GraphBuilder(int num_nodes, int num_node_features)
+    : num_nodes(num_nodes),
+      num_node_features(num_node_features),
+      node_features(num_nodes, vector<float>(num_node_features, 0.0f)),
+      degree(new atomic<int>[num_nodes]) {
+    for (int i = 0; i < num_nodes; i++) {
+        degree[i].store(0, memory_order_relaxed);
+    }
+}
+
+GraphBuilder::Writer GraphBuilder::writer() {
+    lock_guard<mutex> lock(buffers_mutex);
+    buffers.emplace_back(new vector<pair<int, int>>());
+    return Writer(*this, *buffers.back());
+}
+
+void GraphBuilder::set_node_feature(int node_id, const vector<float>& features) {
+    if (node_id < 0 || node_id >= num_nodes) {
+        throw out_of_range("GraphBuilder: node id " + to_string(node_id) + " out of range");
+    }
+    if (static_cast<int>(features.size()) != num_node_features) {
+        throw invalid_argument("GraphBuilder: feature vector of node " + to_string(node_id)
+                               + " has the wrong size");
+    }
+    node_features[node_id] = features;
+}
+
+Graph GraphBuilder::build(const Options& options) {
+    int num_threads = options.num_threads > 0 ? options.num_threads : default_thread_count();
+
+    // Edge buffers seen as one flat range [0, total_edges)
+    vector<size_t> buffer_sizes;
+    for (const auto& buffer : buffers) buffer_sizes.push_back(buffer->size());
+    vector<size_t> edge_offsets;
+    parallel_prefix_sum(buffer_sizes, edge_offsets, 1);
+    size_t total_edges = edge_offsets.back();
+    auto for_each_edge = [&](long long begin, long long end, auto fn) {
+        if (begin >= end) return;
+        size_t b = upper_bound(edge_offsets.begin(), edge_offsets.end(), static_cast<size_t>(begin))
+                   - edge_offsets.begin() - 1;
+        for (long long e = begin; e < end; e++) {
+            while (static_cast<size_t>(e) >= edge_offsets[b + 1]) b++;
+            fn(e, (*buffers[b])[e - edge_offsets[b]]);
+        }
+    };
+
+    // Step 1: list offsets from the atomic degree counts
+    vector<int> counts(num_nodes);
+    parallel_for(0, num_nodes, num_threads, [&](long long begin, long long end, int) {
+        for (long long i = begin; i < end; i++) counts[i] = degree[i].load(memory_order_relaxed);
+    });
+    vector<size_t> offsets;
+    parallel_prefix_sum(counts, offsets, num_threads);
+
+    // Step 2: parallel scatter into the CSR target array; every slot is
+    // claimed with an atomic cursor, so the order inside a list is arbitrary
+    vector<int> targets(offsets.back());
+    unique_ptr<atomic<size_t>[]> cursor(new atomic<size_t>[num_nodes]);
+    parallel_for(0, num_nodes, num_threads, [&](long long begin, long long end, int) {
+        for (long long i = begin; i < end; i++) cursor[i].store(offsets[i], memory_order_relaxed);
+    });
+    parallel_for(0, total_edges, num_threads, [&](long long begin, long long end, int) {
+        for_each_edge(begin, end, [&](long long, const pair<int, int>& edge) {
+            targets[cursor[edge.first].fetch_add(1, memory_order_relaxed)] = edge.second;
+            targets[cursor[edge.second].fetch_add(1, memory_order_relaxed)] = edge.first;
+        });
+    });
+
+    // Step 3: sort every list (fixes the order) and drop unwanted entries in place
+    parallel_for(0, num_nodes, num_threads, [&](long long begin, long long end, int) {
+        for (long long u = begin; u < end; u++) {
+            int* first = targets.data() + offsets[u];
+            int* last = first + counts[u];
+            sort(first, last);
+            if (options.remove_self_loops) {
+                last = remove(first, last, static_cast<int>(u));
+            }
+            if (options.remove_duplicates) {
+                last = unique(first, last);
+            }
+            counts[u] = last - first;
+        }
+    });
+
+    // Step 4: materialise the graph
+    Graph g(0, num_node_features);
+    g.num_nodes = num_nodes;
+    g.node_features = std::move(node_features);
+    g.adjacency_list.resize(num_nodes);
+    parallel_for(0, num_nodes, num_threads, [&](long long begin, long long end, int) {
+        for (long long u = begin; u < end; u++) {
+            const int* first = targets.data() + offsets[u];
+            g.adjacency_list[u].assign(first, first + counts[u]);
+        }
+    });
+
+    // Step 5: edge list
+    if (options.remove_duplicates) {
+        // one (u, v) with u <= v per distinct edge, read back from the sorted lists
+        vector<size_t> kept(num_nodes);
+        parallel_for(0, num_nodes, num_threads, [&](long long begin, long long end, int) {
+            for (long long u = begin; u < end; u++) {
+                const vector<int>& list = g.adjacency_list[u];
+                kept[u] = list.end() - lower_bound(list.begin(), list.end(), static_cast<int>(u));
+            }
+        });
+        vector<size_t> kept_offsets;
+        parallel_prefix_sum(kept, kept_offsets, num_threads);
+        g.edge_list.resize(kept_offsets.back());
+        parallel_for(0, num_nodes, num_threads, [&](long long begin, long long end, int) {
+            for (long long u = begin; u < end; u++) {
+                const vector<int>& list = g.adjacency_list[u];
+                size_t out = kept_offsets[u];
+                for (auto it = lower_bound(list.begin(), list.end(), static_cast<int>(u)); it != list.end(); ++it) {
+                    g.edge_list[out++] = {static_cast<int>(u), *it};
+                }
+            }
+        });
+    } else {
+        // edges in writer order, minus self-loops if requested; the same
+        // deterministic chunks are walked twice (count kept edges, then copy them)
+        int chunks = static_cast<int>(max(1LL, min<long long>(num_threads, total_edges)));
+        vector<size_t> chunk_kept(chunks, 0);
+        auto keep = [&](const pair<int, int>& edge) {
+            return !options.remove_self_loops || edge.first != edge.second;
+        };
+        parallel_for(0, total_edges, chunks, [&](long long begin, long long end, int t) {
+            for_each_edge(begin, end, [&](long long, const pair<int, int>& edge) {
+                if (keep(edge)) chunk_kept[t]++;
+            });
+        });
+        vector<size_t> chunk_offsets;
+        parallel_prefix_sum(chunk_kept, chunk_offsets, 1);
+        g.edge_list.resize(chunk_offsets.back());
+        parallel_for(0, total_edges, chunks, [&](long long begin, long long end, int t) {
+            size_t out = chunk_offsets[t];
+            for_each_edge(begin, end, [&](long long, const pair<int, int>& edge) {
+                if (keep(edge)) g.edge_list[out++] = edge;
+            });
+        });
+    }
+
+    buffers.clear();
+    g.touch(); // members were written directly, not through add_edge
+    return g;
+}
@@ -0,0 +1,70 @@
+// GraphBuilder.h
+
+#pragma once
+#include "Graph.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+// GraphBuilder assembles a Graph from several ingest threads at once.
+//
+// Every thread takes its own Writer and appends edges to a private buffer;
+// the only shared state touched per edge is an atomic degree counter per node.
+// build() then turns the buffers into the adjacency lists with a parallel
+// prefix sum over the degrees and a parallel scatter into one CSR array,
+// optionally drops self-loops and duplicate neighbours (parallel per-node
+// sort), and materialises the Graph.
+//
+// Like Graph::add_edge, edges are undirected: each one lands in both lists.
+// Neighbour lists come out sorted, so the result does not depend on how the
+// edges were spread over the threads.
+class GraphBuilder {
+public:
+    // Cleanup applied by build()
+    struct Options {
+        bool remove_self_loops = false; // drop (v, v) edges
+        bool remove_duplicates = false; // keep each neighbour once per list (and each edge once in edge_list)
+        int num_threads = 0;            // threads used by build(); 0 = default_thread_count()
+    };
+
+    // Appends edges for one thread. Not thread-safe itself: use one per thread.
+    class Writer {
+    public:
+        // Records an undirected edge; throws out_of_range for an invalid node id
+        void add_edge(int src, int dst);
+
+        // Pre-sizes the buffer for 'count' more edges
+        void reserve(size_t count);
+
+    private:
+        friend class GraphBuilder;
+        Writer(GraphBuilder& builder, vector<pair<int, int>>& edges) : builder(&builder), edges(&edges) {}
+
+        GraphBuilder* builder;
+        vector<pair<int, int>>* edges;
+    };
+
+    GraphBuilder(int num_nodes, int num_node_features);
+
+    // A new writer with its own buffer; safe to call from any thread.
+    // Writers stay valid until build().
+    Writer writer();
+
+    // Sets the feature vector of a node; concurrent calls for different nodes are safe.
+    // Throws out_of_range / invalid_argument for a bad node id or feature size.
+    void set_node_feature(int node_id, const vector<float>& features);
+
+    // Builds the graph. Call once, after every writer has finished.
+    Graph build(const Options& options);
+    Graph build() { return build(Options()); }
+
+private:
+    int num_nodes;
+    int num_node_features;
+    vector<vector<float>> node_features;
+    unique_ptr<atomic<int>[]> degree;           // list entries per node (an edge adds one to each end)
+    mutex buffers_mutex;                        // guards 'buffers' (taken only by writer())
+    vector<unique_ptr<vector<pair<int, int>>>> buffers; // one edge buffer per writer
+};
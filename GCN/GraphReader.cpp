@@ -2,6 +2,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <stdexcept>
 
 Graph read_graph_from_file(const string& filename) {
     ifstream infile(filename);
@@ -10,27 +11,56 @@ Graph read_graph_from_file(const string& filename) {
         exit(1);
     }
 
+    Graph g = read_graph_from_stream(infile);
+    infile.close();
+    return g;
+}
+
+Graph read_graph_from_stream(istream& infile) {
+    GraphFileHeader header = read_graph_header(infile);
+    Graph g(header.num_nodes, header.num_features);
+    scan_graph_body(
+        infile, header,
+        [&](int node, const vector<float>& features) { g.set_node_feature(node, features); },
+        [&](int src, int dst) { g.add_edge(src, dst); });
+    return g;
+}
+
+GraphFileHeader read_graph_header(istream& infile) {
     string line;
-    int num_nodes, num_features;
+    GraphFileHeader header;
 
     // Read header
     getline(infile, line);
     istringstream header_stream(line);
-    header_stream >> num_nodes >> num_features;
+    header_stream >> header.num_nodes >> header.num_features;
+    return header;
+}
 
-    Graph g(num_nodes, num_features);
+void scan_graph_body(
+    istream& infile,
+    const GraphFileHeader& header,
+    const function<void(int, const vector<float>&)>& on_features,
+    const function<void(int, int)>& on_edge
+) {
+    string line;
+    int num_nodes = header.num_nodes;
 
     // Read node features
     for (int i = 0; i < num_nodes; i++) {
         getline(infile, line);
+        if (!on_features) continue;
         istringstream iss(line);
         int node_id;
         iss >> node_id;
-        vector<float> features(num_features);
-        for (int j = 0; j < num_features; j++) {
+        if (!iss || node_id < 0 || node_id >= num_nodes) {
+            throw runtime_error("invalid node id in feature line: " + line);
+        }
+        vector<float> features(header.num_features);
+        for (int j = 0; j < header.num_features; j++) {
             iss >> features[j];
         }
-        g.set_node_feature(node_id, features);
+        on_features(node_id, features);
     }
 
     // Read edges
@@ -39,9 +69,24 @@ Graph read_graph_from_file(const string& filename) {
         istringstream iss(line);
         int src, dst;
         iss >> src >> dst;
-        g.add_edge(src, dst);
+        if (!iss || src < 0 || src >= num_nodes || dst < 0 || dst >= num_nodes) {
+            throw runtime_error("invalid edge line: " + line);
+        }
+        if (on_edge) on_edge(src, dst);
     }
+}
 
-    infile.close();
-    return g;
+vector<vector<int>> read_adjacency_from_file(const string& filename, GraphFileHeader* header) {
+    ifstream infile(filename);
+    if (!infile.is_open()) {
+        throw runtime_error("cannot open graph file " + filename);
+    }
+    GraphFileHeader file_header = read_graph_header(infile);
+    vector<vector<int>> adjacency_list(file_header.num_nodes);
+    scan_graph_body(infile, file_header, nullptr, [&](int src, int dst) {
+        adjacency_list[src].push_back(dst);
+        adjacency_list[dst].push_back(src);
+    });
+    if (header) *header = file_header;
+    return adjacency_list;
 }
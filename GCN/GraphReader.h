@@ -2,9 +2,40 @@
 #define GRAPH_DATA_READER_H
 
 #include "Graph.h"
+#include <functional>
+#include <istream>
 #include <string>
+#include <vector>
 using namespace std;
 
 Graph read_graph_from_file(const string& filename);
 
+// Parses a graph in the graph_data.txt format from an already opened stream.
+// Unlike read_graph_from_file it never exits: malformed input (node ids out of
+// range) throws runtime_error, so batch callers can skip bad files.
+Graph read_graph_from_stream(istream& infile);
+
+// First line of a graph file
+struct GraphFileHeader {
+    int num_nodes = 0;
+    int num_features = 0;
+};
+
+// Streaming access for callers that must not hold the whole graph (e.g. shard
+// workers): read_graph_header consumes the header line, scan_graph_body then
+// reports every feature line (on_features(node, values)) and edge line
+// (on_edge(src, dst)) in file order. An empty on_features skips the feature
+// lines without parsing them. Malformed lines throw runtime_error.
+GraphFileHeader read_graph_header(istream& infile);
+void scan_graph_body(
+    istream& infile,
+    const GraphFileHeader& header,
+    const function<void(int, const vector<float>&)>& on_features,
+    const function<void(int, int)>& on_edge
+);
+
+// Neighbour lists of a graph file (same lists and order as read_graph_from_stream),
+// without the features. Throws runtime_error if the file cannot be read.
+vector<vector<int>> read_adjacency_from_file(const string& filename, GraphFileHeader* header = nullptr);
+
 #endif
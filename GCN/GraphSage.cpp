@@ -1,21 +1,28 @@
 // GraphSage.cpp
 
 #include "GraphSage.h"
-#include <random>
+#include "WeightInit.h"
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 // Xavier Initialization
-GraphSAGELayer::GraphSAGELayer(int input_dim, int output_dim) : input_dim(input_dim), output_dim(output_dim) {
-    weight_matrix.resize(2 * input_dim, vector<float>(output_dim));
+GraphSAGELayer::GraphSAGELayer(int input_dim, int output_dim)
+    : GraphSAGELayer(input_dim, output_dim, random_seed()) {}
+
+// Xavier Initialization from a fixed seed
+GraphSAGELayer::GraphSAGELayer(int input_dim, int output_dim, uint64_t seed) : input_dim(input_dim), output_dim(output_dim) {
+    weight_matrix.resize(2 * input_dim * output_dim);
     float limit = sqrt(6.0f / (2 * input_dim + output_dim));
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<> dis(0, limit);
+    init_uniform(weight_matrix, 0.0f, limit, seed);
+}
 
-    for (int i = 0; i < 2 * input_dim; i++)
-        for (int j = 0; j < output_dim; j++)
-            weight_matrix[i][j] = dis(gen);
+// Existing packed weights
+GraphSAGELayer::GraphSAGELayer(int input_dim, int output_dim, vector<float> weights)
+    : input_dim(input_dim), output_dim(output_dim), weight_matrix(std::move(weights)) {
+    if (weight_matrix.size() != 2 * static_cast<size_t>(input_dim) * output_dim) {
+        throw invalid_argument("GraphSAGELayer: weight matrix size does not match dimensions");
+    }
 }
 
 // ReLU activation
@@ -23,17 +30,79 @@ float GraphSAGELayer::relu(float x) {
     return max(0.0f, x);
 }
 
-// Mean aggregation of neighbor features
+// Copies one feature chunk of the tile's own features into the block
+void GraphSAGELayer::gather_self_tile(
+    const int* tile_rows, int tile_size,
+    int chunk_begin, int width,
+    const vector<vector<float>>& node_features,
+    float* block
+) {
+    for (int t = 0; t < tile_size; t++) {
+        const float* x = node_features[tile_rows[t]].data() + chunk_begin;
+        copy(x, x + width, block + t * kFeatureChunk);
+    }
+}
+
+// Mean aggregation of one feature chunk of the tile's neighbors
+void GraphSAGELayer::aggregate_mean_tile(
+    const int* tile_rows, int tile_size,
+    int chunk_begin, int width,
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    float* block
+) {
+    for (int t = 0; t < tile_size; t++) {
+        int i = tile_rows[t];
+        float* row = block + t * kFeatureChunk;
+        fill(row, row + width, 0.0f);
+        int neighbor_count = adjacency_list[i].size();
+
+        if (neighbor_count > 0) {
+            for (int neighbor : adjacency_list[i]) {
+                const float* x = node_features[neighbor].data() + chunk_begin;
+                for (int d = 0; d < width; d++) {
+                    row[d] += x[d];
+                }
+            }
+            for (int d = 0; d < width; d++) {
+                row[d] /= neighbor_count; // mean aggregation
+            }
+        }
+    }
+}
+
+// Multiplies the block into the tile accumulators; each output is accumulated
+// over the concatenated dimensions in ascending order, as in linear_transform
+void GraphSAGELayer::transform_tile(
+    int tile_size,
+    int weight_row, int width,
+    const float* block,
+    float* accumulators
+) {
+    for (int t = 0; t < tile_size; t++) {
+        const float* row = block + t * kFeatureChunk;
+        float* out = accumulators + t * output_dim;
+        for (int d = 0; d < width; d++) {
+            float a = row[d];
+            const float* w = weight_matrix.data() + (weight_row + d) * output_dim;
+            for (int o = 0; o < output_dim; o++) {
+                out[o] += a * w[o];
+            }
+        }
+    }
+}
+
+// Mean aggregation of neighbor features, decoding the neighbor list on the fly
 vector<float> GraphSAGELayer::aggregate_neighbors_mean(
     int node,
     const vector<vector<float>>& node_features,
-    const vector<vector<int>>& adjacency_list
+    const CompressedAdjacency& adjacency
 ) {
     vector<float> neighbor_agg(input_dim, 0.0f);
-    int neighbor_count = adjacency_list[node].size();
+    int neighbor_count = adjacency.degree(node);
 
     if (neighbor_count > 0) {
-        for (int neighbor : adjacency_list[node]) {
+        for (int neighbor : adjacency.neighbors(node)) {
             for (int d = 0; d < input_dim; d++) {
                 neighbor_agg[d] += node_features[neighbor][d];
             }
@@ -65,7 +134,7 @@ float GraphSAGELayer::linear_transform(
 ) {
     float val = 0.0f;
     for (int d = 0; d < 2 * input_dim; d++) {
-        val += concat_features[d] * weight_matrix[d][output_index];
+        val += concat_features[d] * weight_matrix[d * output_dim + output_index];
     }
     return val;
 }
@@ -78,8 +147,65 @@ vector<vector<float>> GraphSAGELayer::forward(
     int n_nodes = node_features.size();
     vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
 
+    vector<int> rows(n_nodes);
+    for (int i = 0; i < n_nodes; i++) {
+        rows[i] = i;
+    }
+    forward_rows(node_features, adjacency_list, rows, updated_features);
+
+    return updated_features;
+}
+
+// Fused aggregate -> concat -> transform -> ReLU, one tile of nodes at a time.
+// The concatenation is never built: the self half and the neighbour half are
+// multiplied by their own weight rows (self rows first, as in linear_transform).
+void GraphSAGELayer::forward_rows(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& rows,
+    vector<vector<float>>& out
+) {
+    int n_rows = rows.size();
+    vector<float> block(kTileNodes * kFeatureChunk);
+    vector<float> accumulators(kTileNodes * output_dim);
+    for (int tile_begin = 0; tile_begin < n_rows; tile_begin += kTileNodes) {
+        const int* tile_rows = rows.data() + tile_begin;
+        int tile_size = min(kTileNodes, n_rows - tile_begin);
+        fill(accumulators.begin(), accumulators.end(), 0.0f);
+
+        for (int chunk_begin = 0; chunk_begin < input_dim; chunk_begin += kFeatureChunk) {
+            int width = min(kFeatureChunk, input_dim - chunk_begin);
+            gather_self_tile(tile_rows, tile_size, chunk_begin, width, node_features, block.data());
+            transform_tile(tile_size, chunk_begin, width, block.data(), accumulators.data());
+        }
+        for (int chunk_begin = 0; chunk_begin < input_dim; chunk_begin += kFeatureChunk) {
+            int width = min(kFeatureChunk, input_dim - chunk_begin);
+            aggregate_mean_tile(tile_rows, tile_size, chunk_begin, width,
+                                node_features, adjacency_list, block.data());
+            transform_tile(tile_size, input_dim + chunk_begin, width, block.data(), accumulators.data());
+        }
+
+        for (int t = 0; t < tile_size; t++) {
+            const float* acc = accumulators.data() + t * output_dim;
+            vector<float>& out_row = out[tile_rows[t]];
+            out_row.resize(output_dim);
+            for (int o = 0; o < output_dim; o++) {
+                out_row[o] = relu(acc[o]);
+            }
+        }
+    }
+}
+
+// Forward pass for GraphSAGE layer over a compressed adjacency
+vector<vector<float>> GraphSAGELayer::forward(
+    const vector<vector<float>>& node_features,
+    const CompressedAdjacency& adjacency
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+
     for (int i = 0; i < n_nodes; i++) {
-        vector<float> neighbor_agg = aggregate_neighbors_mean(i, node_features, adjacency_list);
+        vector<float> neighbor_agg = aggregate_neighbors_mean(i, node_features, adjacency);
         vector<float> concat_features = concatenate_self_and_neighbors(node_features[i], neighbor_agg);
 
         for (int o = 0; o < output_dim; o++) {
@@ -90,3 +216,206 @@ vector<vector<float>> GraphSAGELayer::forward(
 
     return updated_features;
 }
+
+// Forward pass for GraphSAGE layer over sparse input activations.
+// Skipped entries are exact zeros, so the sums match the dense pass bit for bit.
+vector<vector<float>> GraphSAGELayer::forward(
+    const SparseFeatures& node_features,
+    const vector<vector<int>>& adjacency_list
+) {
+    int n_nodes = node_features.num_rows;
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+
+    vector<float> neighbor_agg(input_dim);
+    for (int i = 0; i < n_nodes; i++) {
+        vector<float>& out = updated_features[i];
+
+        // self half of the concatenation
+        for (int k = node_features.row_offsets[i]; k < node_features.row_offsets[i + 1]; k++) {
+            float a = node_features.values[k];
+            const float* w = weight_matrix.data() + node_features.col_indices[k] * output_dim;
+            for (int o = 0; o < output_dim; o++) {
+                out[o] += a * w[o];
+            }
+        }
+
+        // neighbour half: mean of the neighbours' non-zeros
+        fill(neighbor_agg.begin(), neighbor_agg.end(), 0.0f);
+        int neighbor_count = adjacency_list[i].size();
+        if (neighbor_count > 0) {
+            for (int neighbor : adjacency_list[i]) {
+                for (int k = node_features.row_offsets[neighbor]; k < node_features.row_offsets[neighbor + 1]; k++) {
+                    neighbor_agg[node_features.col_indices[k]] += node_features.values[k];
+                }
+            }
+            for (int d = 0; d < input_dim; d++) {
+                neighbor_agg[d] /= neighbor_count; // mean aggregation
+            }
+        }
+        for (int d = 0; d < input_dim; d++) {
+            float a = neighbor_agg[d];
+            if (a == 0.0f) continue;
+            const float* w = weight_matrix.data() + (input_dim + d) * output_dim;
+            for (int o = 0; o < output_dim; o++) {
+                out[o] += a * w[o];
+            }
+        }
+
+        for (int o = 0; o < output_dim; o++) {
+            out[o] = relu(out[o]);
+        }
+    }
+
+    return updated_features;
+}
+
+// Degree-aware forward pass for GraphSAGE layer. Hub segments produce partial
+// neighbour sums; the merged sum is divided by the degree and then
+// concatenated and transformed as in the per-node path.
+vector<vector<float>> GraphSAGELayer::forward_split(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const HubSplitOptions& options
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+    HubSplitPlan plan = plan_hub_split(adjacency_list, options);
+    vector<vector<float>> partial(plan.segments.size());
+
+    run_hub_split(plan, options.num_threads,
+        [&](const vector<int>& rows) {
+            forward_rows(node_features, adjacency_list, rows, updated_features);
+        },
+        [&](size_t s) {
+            const HubSplitPlan::Segment& segment = plan.segments[s];
+            const vector<int>& neighbors = adjacency_list[segment.node];
+            vector<float>& sum = partial[s];
+            sum.assign(input_dim, 0.0f);
+            for (int k = segment.begin; k < segment.end; k++) {
+                for (int d = 0; d < input_dim; d++) {
+                    sum[d] += node_features[neighbors[k]][d];
+                }
+            }
+        },
+        [&](size_t h) {
+            int first = plan.hub_segment_begin[h];
+            merge_partial_sums(partial.data() + first, plan.hub_segment_begin[h + 1] - first);
+            int node = plan.hubs[h];
+            vector<float>& mean = partial[first];
+            int neighbor_count = adjacency_list[node].size();
+            for (int d = 0; d < input_dim; d++) {
+                mean[d] /= neighbor_count;
+            }
+            vector<float> concat_features = concatenate_self_and_neighbors(node_features[node], mean);
+            vector<float>& out_row = updated_features[node];
+            for (int o = 0; o < output_dim; o++) {
+                out_row[o] = relu(linear_transform(concat_features, o));
+            }
+        });
+
+    return updated_features;
+}
+
+// Gradient buffer, allocated on first use
+vector<vector<float>*> GraphSAGELayer::gradients() {
+    weight_grad.resize(weight_matrix.size(), 0.0f);
+    return {&weight_grad};
+}
+
+// Mean aggregation of all nodes, in the same order as aggregate_mean_tile
+vector<vector<float>> GraphSAGELayer::aggregate_all_mean(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> means(n_nodes, vector<float>(input_dim, 0.0f));
+    for (int i = 0; i < n_nodes; i++) {
+        int neighbor_count = adjacency_list[i].size();
+        if (neighbor_count > 0) {
+            for (int neighbor : adjacency_list[i]) {
+                for (int d = 0; d < input_dim; d++) {
+                    means[i][d] += node_features[neighbor][d];
+                }
+            }
+            for (int d = 0; d < input_dim; d++) {
+                means[i][d] /= neighbor_count;
+            }
+        }
+    }
+    return means;
+}
+
+// Training forward pass for GraphSAGE layer
+vector<vector<float>> GraphSAGELayer::forward_train(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    bool keep_intermediates
+) {
+    int n_nodes = node_features.size();
+    vector<vector<float>> means = aggregate_all_mean(node_features, adjacency_list);
+    vector<vector<float>> updated_features(n_nodes, vector<float>(output_dim, 0.0f));
+    for (int i = 0; i < n_nodes; i++) {
+        vector<float> concat_features = concatenate_self_and_neighbors(node_features[i], means[i]);
+        for (int o = 0; o < output_dim; o++) {
+            updated_features[i][o] = relu(linear_transform(concat_features, o));
+        }
+    }
+
+    if (keep_intermediates) {
+        stored_means = std::move(means);
+    } else {
+        stored_means.clear(); // never let backward() pick up an older step's means
+    }
+    return updated_features;
+}
+
+// Backward pass for GraphSAGE layer
+vector<vector<float>> GraphSAGELayer::backward(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<vector<float>>& output,
+    const vector<vector<float>>& grad_output
+) {
+    int n_nodes = node_features.size();
+    if (!stored_means.empty() && static_cast<int>(stored_means.size()) != n_nodes) {
+        throw logic_error("GraphSAGELayer::backward: stored means do not match the layer input");
+    }
+    vector<vector<float>> means = stored_means.empty()
+        ? aggregate_all_mean(node_features, adjacency_list)
+        : std::move(stored_means);
+    stored_means.clear();
+    gradients();
+
+    vector<vector<float>> grad_input(n_nodes, vector<float>(input_dim, 0.0f));
+    vector<float> grad_pre(output_dim);       // gradient before the ReLU
+    vector<float> grad_concat(2 * input_dim); // gradient of [self, neighbour mean]
+    for (int i = 0; i < n_nodes; i++) {
+        for (int o = 0; o < output_dim; o++) {
+            grad_pre[o] = output[i][o] > 0.0f ? grad_output[i][o] : 0.0f;
+        }
+
+        for (int d = 0; d < 2 * input_dim; d++) {
+            float x = d < input_dim ? node_features[i][d] : means[i][d - input_dim];
+            const float* w = weight_matrix.data() + d * output_dim;
+            float* g = weight_grad.data() + d * output_dim;
+            float sum = 0.0f;
+            for (int o = 0; o < output_dim; o++) {
+                g[o] += x * grad_pre[o];
+                sum += w[o] * grad_pre[o];
+            }
+            grad_concat[d] = sum;
+        }
+
+        for (int d = 0; d < input_dim; d++) {
+            grad_input[i][d] += grad_concat[d];
+        }
+        int neighbor_count = adjacency_list[i].size();
+        for (int neighbor : adjacency_list[i]) {
+            vector<float>& target = grad_input[neighbor];
+            for (int d = 0; d < input_dim; d++) {
+                target[d] += grad_concat[input_dim + d] / neighbor_count;
+            }
+        }
+    }
+    return grad_input;
+}
@@ -2,6 +2,7 @@
 
 #pragma once
 #include "BaseLayer.h"
+#include <cstdint>
 #include <vector>
 using namespace std;
 
@@ -14,26 +15,125 @@ public:
     // performs Xavier initialisation of weight matrix.
     GraphSAGELayer(int input_dim, int output_dim);
 
+    // Same Xavier initialisation drawn from a fixed seed, so the weights are reproducible
+    GraphSAGELayer(int input_dim, int output_dim, uint64_t seed);
+
+    // Uses existing packed weights, row-major [2 * input_dim * output_dim] (e.g. from a checkpoint)
+    GraphSAGELayer(int input_dim, int output_dim, vector<float> weights);
+
+    int get_input_dim() const override { return input_dim; }
+    int get_output_dim() const override { return output_dim; }
+    string type_name() const override { return "sage"; }
+    vector<vector<float>*> parameters() override { return {&weight_matrix}; }
+    vector<vector<float>*> gradients() override;
+
     // forward pass computes updated node features by aggregating neighbour features,
     // concatenating with self-features and multiplying with weight matrix followed by ReLU.
+    // Aggregation, concatenation, transformation and ReLU are fused per tile of kTileNodes nodes.
+    vector<vector<float>> forward(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list   // represents the graph
+    ) override;
+
+    // fused forward pass restricted to the listed nodes
+    void forward_rows(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const vector<int>& rows,                    // nodes to compute
+        vector<vector<float>>& out                  // output matrix, rows written in place
+    ) override;
+
+    // same forward pass, decoding neighbour lists on the fly
     vector<vector<float>> forward(
         const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const CompressedAdjacency& adjacency        // compressed graph structure
+    ) override;
+
+    // same forward pass over sparse input activations: the self half uses only
+    // the stored non-zeros and zero neighbour means are skipped in the projection
+    vector<vector<float>> forward(
+        const SparseFeatures& node_features,        // sparse node-feature matrix:[number of nodes][input_dim]
         const vector<vector<int>>& adjacency_list   // represents the graph
     ) override;
 
+    // degree-aware forward pass: hub nodes are aggregated in segments
+    // by different workers and their partial sums merged pairwise
+    vector<vector<float>> forward_split(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const HubSplitOptions& options              // threshold, segment size, workers
+    ) override;
+
+    // training forward pass: mean-aggregates all nodes, then transforms;
+    // keeps the neighbour means for backward() if asked to
+    vector<vector<float>> forward_train(
+        const vector<vector<float>>& node_features, // node-feature matrix:[number of nodes][input_dim]
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        bool keep_intermediates                     // store neighbour means instead of recomputing them
+    ) override;
+
+    // backward pass: the self half of dOut * W^T goes straight to the node,
+    // the neighbour half is divided by the degree and scattered back along
+    // the node's neighbour list (the transposed mean aggregation)
+    vector<vector<float>> backward(
+        const vector<vector<float>>& node_features, // layer input
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const vector<vector<float>>& output,        // result of forward_train
+        const vector<vector<float>>& grad_output    // dLoss/dOutput
+    ) override;
+
 private:
+    static constexpr int kTileNodes = 16;     // destination nodes processed together
+    static constexpr int kFeatureChunk = 256; // input dimensions per block (keeps the weight panel in L2)
+
     int input_dim;              // dimension of input features
     int output_dim;             // dimension of output features
-    vector<vector<float>> weight_matrix; // weight matrix of shape [input_dim][output_dim]
+    vector<float> weight_matrix; // packed weight panel, row-major [2 * input_dim * output_dim]
+    vector<float> weight_grad;   // gradient of weight_matrix (same layout), filled by backward
+    vector<vector<float>> stored_means; // neighbour means kept by forward_train for backward
     
     // Applies ReLU activation to single float value
     float relu(float x);
 
-    // Aggregates features of the neighbours of this node using mean aggregation.
+    // Copies input dimensions [chunk_begin, chunk_begin + width) of the self
+    // features of the tile's nodes into the [kTileNodes][kFeatureChunk] block
+    void gather_self_tile(
+        const int* tile_rows, int tile_size,        // nodes of the tile
+        int chunk_begin, int width,                 // input dimensions of the chunk
+        const vector<vector<float>>& node_features, // input node feature matrix
+        float* block                                // output block
+    );
+
+    // Mean-aggregates the same chunk of the neighbour features of the tile into the block
+    void aggregate_mean_tile(
+        const int* tile_rows, int tile_size,        // nodes of the tile
+        int chunk_begin, int width,                 // input dimensions of the chunk
+        const vector<vector<float>>& node_features, // input node feature matrix
+        const vector<vector<int>>& adjacency_list,  // graph representation
+        float* block                                // output block
+    );
+
+    // Multiplies the block by weight rows [weight_row, weight_row + width)
+    // and adds the result to the tile's accumulators ([tile_size][output_dim])
+    void transform_tile(
+        int tile_size,
+        int weight_row, int width,
+        const float* block,
+        float* accumulators
+    );
+
+    // Neighbour means of every node:[number of nodes][input_dim]
+    vector<vector<float>> aggregate_all_mean(
+        const vector<vector<float>>& node_features, // input node feature matrix
+        const vector<vector<int>>& adjacency_list   // graph representation
+    );
+
+    // Aggregates features of the neighbours of this node using mean aggregation,
+    // reading the neighbours from a compressed adjacency
     vector<float> aggregate_neighbors_mean(
         int node,                                   // index of the central node
         const vector<vector<float>>& node_features, // input node feature matrix
-        const vector<vector<int>>& adjacency_list   // graph representation
+        const CompressedAdjacency& adjacency        // compressed graph representation
     );
 
     // CONCATENATES node's own features to the aggregated neighbour features
@@ -0,0 +1,107 @@
+// HubSplit.h
+
+#pragma once
+#include "Parallel.h"
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// Degree-aware execution: neighbour lists longer than degree_threshold are cut
+// into segments of segment_size neighbours, so no single task (or its scratch
+// memory) grows with the largest degree in the graph.
+struct HubSplitOptions {
+    int degree_threshold = 4096; // nodes with more neighbours than this are split
+    int segment_size = 0;        // neighbours per segment; 0 = degree_threshold
+    int num_threads = 0;         // workers; 0 = default_thread_count()
+};
+
+// Task list of one degree-aware layer pass
+struct HubSplitPlan {
+    struct Segment {
+        int node;   // hub the segment belongs to
+        int begin;  // neighbour positions [begin, end) of adjacency_list[node]
+        int end;
+    };
+
+    vector<vector<int>> light_chunks;  // ordinary nodes, chunked to about segment_size neighbours each
+    vector<int> hubs;                  // split nodes, ascending
+    vector<Segment> segments;          // segments of every hub, hub by hub, in list order
+    vector<int> hub_segment_begin;     // first segment of each hub, [hubs.size() + 1]
+};
+
+// Splits the nodes of a graph into light chunks and hub segments.
+// Throws invalid_argument for a degree threshold below 1.
+inline HubSplitPlan plan_hub_split(const vector<vector<int>>& adjacency_list, const HubSplitOptions& options) {
+    if (options.degree_threshold < 1) {
+        throw invalid_argument("hub splitting needs a degree threshold of at least 1");
+    }
+    int segment_size = options.segment_size > 0 ? options.segment_size : options.degree_threshold;
+
+    HubSplitPlan plan;
+    vector<int> chunk;
+    long long chunk_work = 0;
+    int n_nodes = adjacency_list.size();
+    for (int i = 0; i < n_nodes; i++) {
+        int degree = adjacency_list[i].size();
+        if (degree > options.degree_threshold) {
+            plan.hubs.push_back(i);
+            plan.hub_segment_begin.push_back(plan.segments.size());
+            for (int begin = 0; begin < degree; begin += segment_size) {
+                plan.segments.push_back({i, begin, min(degree, begin + segment_size)});
+            }
+            continue;
+        }
+        chunk.push_back(i);
+        chunk_work += degree + 1;
+        if (chunk_work >= segment_size) {
+            plan.light_chunks.push_back(std::move(chunk));
+            chunk.clear();
+            chunk_work = 0;
+        }
+    }
+    if (!chunk.empty()) plan.light_chunks.push_back(std::move(chunk));
+    plan.hub_segment_begin.push_back(plan.segments.size());
+    return plan;
+}
+
+// Runs a plan in two phases.
+// Phase 1: workers take hub segments, then light chunks, from one shared
+//   counter (dynamic scheduling, so a slow task does not leave the other
+//   workers idle behind a static split): segment(s) for segment index s,
+//   light(rows) for a chunk of ordinary nodes.
+// Phase 2: merge(h) for every hub index h, in parallel across hubs.
+template <typename LightFn, typename SegmentFn, typename MergeFn>
+void run_hub_split(const HubSplitPlan& plan, int num_threads, LightFn light, SegmentFn segment, MergeFn merge) {
+    if (num_threads <= 0) num_threads = default_thread_count();
+    long long n_segments = plan.segments.size();
+    long long n_tasks = n_segments + plan.light_chunks.size();
+
+    atomic<long long> next_task{0};
+    parallel_for(0, num_threads, num_threads, [&](long long, long long, int) {
+        for (long long task = next_task++; task < n_tasks; task = next_task++) {
+            if (task < n_segments) segment(static_cast<size_t>(task));
+            else light(plan.light_chunks[task - n_segments]);
+        }
+    });
+
+    parallel_for(0, plan.hubs.size(), num_threads, [&](long long begin, long long end, int) {
+        for (long long h = begin; h < end; h++) merge(static_cast<size_t>(h));
+    });
+}
+
+// Adds partial vectors [first, first + count) pairwise (a fixed binary tree,
+// so the rounding error grows with log(count) and the result is deterministic).
+// The sum ends up in *first.
+inline void merge_partial_sums(vector<float>* first, int count) {
+    for (int stride = 1; stride < count; stride *= 2) {
+        for (int k = 0; k + stride < count; k += 2 * stride) {
+            vector<float>& target = first[k];
+            const vector<float>& source = first[k + stride];
+            for (size_t d = 0; d < target.size(); d++) {
+                target[d] += source[d];
+            }
+        }
+    }
+}
@@ -0,0 +1,218 @@
+// InferenceSession.cpp
+
+#include "InferenceSession.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+ReceptiveField receptive_field(const vector<vector<int>>& adjacency_list, const vector<int>& targets, int hops) {
+    ReceptiveField field;
+    unordered_map<int, int> local_of;
+    for (int t : targets) {
+        if (local_of.emplace(t, field.nodes.size()).second) {
+            field.nodes.push_back(t);
+        }
+    }
+    field.hop_end.push_back(field.nodes.size());
+
+    // breadth-first, one ring per hop
+    size_t ring_begin = 0;
+    for (int h = 1; h <= hops; h++) {
+        size_t ring_end = field.nodes.size();
+        for (size_t k = ring_begin; k < ring_end; k++) {
+            for (int u : adjacency_list[field.nodes[k]]) {
+                if (local_of.emplace(u, field.nodes.size()).second) {
+                    field.nodes.push_back(u);
+                }
+            }
+        }
+        field.hop_end.push_back(field.nodes.size());
+        ring_begin = ring_end;
+    }
+
+    int n_local = field.nodes.size();
+    int inner = hops > 0 ? field.hop_end[hops - 1] : 0; // nodes whose lists are read
+    field.local_adjacency.resize(n_local);
+    field.degree.resize(n_local);
+    for (int k = 0; k < n_local; k++) {
+        field.degree[k] = adjacency_list[field.nodes[k]].size();
+    }
+    for (int k = 0; k < inner; k++) {
+        const vector<int>& neighbors = adjacency_list[field.nodes[k]];
+        vector<int>& local = field.local_adjacency[k];
+        local.reserve(neighbors.size());
+        for (int u : neighbors) {
+            local.push_back(local_of[u]);
+        }
+    }
+    return field;
+}
+
+vector<vector<float>> forward_receptive_field(
+    const LayerStack& stack,
+    const vector<vector<float>>& node_features,
+    const ReceptiveField& field
+) {
+    int n_local = field.nodes.size();
+    int n_layers = stack.size();
+    vector<vector<float>> local(n_local);
+    for (int k = 0; k < n_local; k++) {
+        local[k] = node_features[field.nodes[k]];
+    }
+
+    vector<int> rows;
+    vector<vector<float>> next;
+    for (int l = 0; l < n_layers; l++) {
+        BaseLayer& layer = stack.layer(l);
+        rows.resize(field.hop_end[n_layers - 1 - l]);
+        for (size_t k = 0; k < rows.size(); k++) rows[k] = k;
+
+        next.assign(n_local, vector<float>(layer.get_output_dim(), 0.0f));
+        layer.forward_local_rows(local, field.local_adjacency, field.degree, rows, next);
+        swap(local, next);
+    }
+
+    local.resize(field.hop_end[0]);
+    return local;
+}
+
+InferenceSession::InferenceSession(Graph graph, LayerStack stack, const SessionOptions& options)
+    : g(std::move(graph)),
+      stack(std::move(stack)),
+      options(options),
+      batches(2 * static_cast<size_t>(max(1, options.num_workers))) {
+    if (this->stack.size() > 0 && this->stack.get_input_dim() != g.num_node_features) {
+        throw invalid_argument("InferenceSession: model expects " + to_string(this->stack.get_input_dim())
+                               + " input features, graph has " + to_string(g.num_node_features));
+    }
+    scheduler = thread(&InferenceSession::schedule, this);
+    for (int w = 0; w < max(1, options.num_workers); w++) {
+        workers.emplace_back(&InferenceSession::work, this);
+    }
+}
+
+InferenceSession::~InferenceSession() {
+    {
+        lock_guard<mutex> lock(pending_mutex);
+        stopping = true;
+    }
+    pending_cv.notify_all();
+    scheduler.join();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+future<InferenceResult> InferenceSession::submit(vector<int> nodes) {
+    Request request;
+    request.nodes = std::move(nodes);
+    request.arrival = Clock::now();
+    future<InferenceResult> result = request.result.get_future();
+
+    for (int node : request.nodes) {
+        if (node < 0 || node >= g.num_nodes) {
+            request.result.set_exception(make_exception_ptr(
+                invalid_argument("InferenceSession: node id " + to_string(node) + " out of range")));
+            return result;
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(pending_mutex);
+        if (stopping) {
+            request.result.set_exception(make_exception_ptr(
+                runtime_error("InferenceSession: session is shutting down")));
+            return result;
+        }
+        pending.push_back(std::move(request));
+    }
+    pending_cv.notify_all();
+    return result;
+}
+
+SessionStats InferenceSession::stats() const {
+    SessionStats s;
+    s.requests = total_requests.load();
+    s.batches = total_batches.load();
+    s.computed_nodes = total_computed_nodes.load();
+    return s;
+}
+
+// Forms batches: waits for a first request, gives it batch_window to gather
+// company (or until the batch is full), then hands the batch to the workers
+void InferenceSession::schedule() {
+    size_t max_requests = max<size_t>(1, options.max_batch_requests);
+    while (true) {
+        Batch batch;
+        {
+            unique_lock<mutex> lock(pending_mutex);
+            pending_cv.wait(lock, [&] { return !pending.empty() || stopping; });
+            if (pending.empty()) break; // stopping and drained
+
+            Clock::time_point deadline = pending.front().arrival + options.batch_window;
+            pending_cv.wait_until(lock, deadline, [&] { return pending.size() >= max_requests || stopping; });
+
+            size_t count = min(max_requests, pending.size());
+            for (size_t r = 0; r < count; r++) {
+                batch.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+        }
+        batches.push(std::move(batch));
+    }
+    batches.close();
+}
+
+void InferenceSession::work() {
+    while (optional<Batch> batch = batches.pop()) {
+        run_batch(*batch);
+    }
+}
+
+// One computation over the union of the batch's receptive fields
+void InferenceSession::run_batch(Batch& batch) {
+    Clock::time_point start = Clock::now();
+
+    vector<int> targets;
+    for (const Request& request : batch) {
+        targets.insert(targets.end(), request.nodes.begin(), request.nodes.end());
+    }
+
+    ReceptiveField field;
+    vector<vector<float>> rows;
+    try {
+        field = receptive_field(g.adjacency_list, targets, stack.size());
+        rows = forward_receptive_field(stack, g.node_features, field);
+    } catch (...) {
+        for (Request& request : batch) {
+            request.result.set_exception(current_exception());
+        }
+        return;
+    }
+    Clock::time_point done = Clock::now();
+    double compute_seconds = chrono::duration<double>(done - start).count();
+
+    unordered_map<int, int> row_of;
+    for (int k = 0; k < field.hop_end[0]; k++) {
+        row_of.emplace(field.nodes[k], k);
+    }
+
+    total_requests += batch.size();
+    total_batches++;
+    total_computed_nodes += field.nodes.size();
+
+    for (Request& request : batch) {
+        InferenceResult result;
+        result.embeddings.reserve(request.nodes.size());
+        for (int node : request.nodes) {
+            result.embeddings.push_back(rows[row_of[node]]);
+        }
+        result.timing.queue_seconds = chrono::duration<double>(start - request.arrival).count();
+        result.timing.compute_seconds = compute_seconds;
+        result.timing.total_seconds = chrono::duration<double>(Clock::now() - request.arrival).count();
+        result.timing.batch_requests = batch.size();
+        result.timing.batch_nodes = field.nodes.size();
+        request.result.set_value(std::move(result));
+    }
+}
@@ -0,0 +1,128 @@
+// InferenceSession.h
+
+#pragma once
+#include "BoundedQueue.h"
+#include "Graph.h"
+#include "LayerStack.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Induced k-hop neighbourhood of a node set, numbered ring by ring:
+// local ids [0, hop_end[0]) are the targets, [hop_end[h-1], hop_end[h]) the
+// nodes exactly h hops away. Nodes within hops - 1 keep their full neighbour
+// lists (in local ids, same order); the outer ring only supplies features and
+// its degree, so its lists are empty (degree-based normalisation reads
+// 'degree' and stays exact, as for partition halos).
+struct ReceptiveField {
+    vector<int> nodes;                   // global id of each local node
+    vector<int> hop_end;                 // local nodes within h hops, h = 0..hops
+    vector<vector<int>> local_adjacency; // neighbour lists in local ids (outer ring empty)
+    vector<int> degree;                  // global degree of each local node
+};
+
+// Builds the receptive field of 'targets' (duplicates are merged)
+ReceptiveField receptive_field(const vector<vector<int>>& adjacency_list, const vector<int>& targets, int hops);
+
+// Runs the stack over a receptive field with hops == stack.size(), computing at
+// layer l only the rows that later layers still read (within size - 1 - l hops).
+// Returns the output rows of the targets, in local order; identical to the
+// corresponding rows of LayerStack::forward on the whole graph.
+vector<vector<float>> forward_receptive_field(
+    const LayerStack& stack,
+    const vector<vector<float>>& node_features, // global feature matrix
+    const ReceptiveField& field
+);
+
+// Latency / throughput knobs of an InferenceSession
+struct SessionOptions {
+    chrono::microseconds batch_window{2000}; // how long the first request of a batch waits for company
+    size_t max_batch_requests = 64;          // a batch closes early once it holds this many requests
+    int num_workers = 1;                     // batches computed concurrently
+};
+
+// Timing of one request
+struct RequestTiming {
+    double queue_seconds = 0.0;   // arrival until its batch started computing
+    double compute_seconds = 0.0; // the batch's computation
+    double total_seconds = 0.0;   // arrival until the result was ready
+    int batch_requests = 0;       // requests merged into the batch
+    int batch_nodes = 0;          // receptive field size of the batch
+};
+
+// Answer to one request: one embedding per requested node, in request order
+struct InferenceResult {
+    vector<vector<float>> embeddings;
+    RequestTiming timing;
+};
+
+// Totals over the lifetime of a session
+struct SessionStats {
+    long long requests = 0;
+    long long batches = 0;
+    long long computed_nodes = 0; // sum of the batches' receptive field sizes
+
+    double mean_batch_requests() const { return batches == 0 ? 0.0 : static_cast<double>(requests) / batches; }
+};
+
+// InferenceSession serves node-embedding lookups on one graph and model.
+// submit() may be called from any thread and returns a future at once.
+// A scheduler thread collects requests: the first request of a batch waits up
+// to batch_window (or until max_batch_requests have arrived), then the batch
+// is handed to a worker, which runs the stack once over the union of the
+// requests' receptive fields and fulfils every request from that result.
+class InferenceSession {
+public:
+    InferenceSession(Graph graph, LayerStack stack, const SessionOptions& options = SessionOptions());
+
+    // Finishes every request already submitted, then stops the threads
+    ~InferenceSession();
+
+    InferenceSession(const InferenceSession&) = delete;
+    InferenceSession& operator=(const InferenceSession&) = delete;
+
+    // Requests the embeddings of 'nodes'. Invalid node ids make the future
+    // throw invalid_argument.
+    future<InferenceResult> submit(vector<int> nodes);
+
+    const Graph& graph() const { return g; }
+    const LayerStack& model() const { return stack; }
+    SessionStats stats() const;
+
+private:
+    using Clock = chrono::steady_clock;
+
+    struct Request {
+        vector<int> nodes;
+        promise<InferenceResult> result;
+        Clock::time_point arrival;
+    };
+    using Batch = vector<Request>;
+
+    Graph g;
+    LayerStack stack;
+    SessionOptions options;
+
+    mutex pending_mutex;            // guards 'pending' and 'stopping'
+    condition_variable pending_cv;
+    deque<Request> pending;         // submitted, not yet batched
+    bool stopping = false;
+
+    BoundedQueue<Batch> batches;    // formed batches waiting for a worker
+    thread scheduler;
+    vector<thread> workers;
+
+    atomic<long long> total_requests{0};
+    atomic<long long> total_batches{0};
+    atomic<long long> total_computed_nodes{0};
+
+    void schedule();
+    void work();
+    void run_batch(Batch& batch);
+};
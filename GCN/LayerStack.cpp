@@ -0,0 +1,90 @@
+// LayerStack.cpp
+
+#include "LayerStack.h"
+#include "GATL.h"
+#include "GCNL.h"
+#include "GraphSage.h"
+#include "WeightInit.h"
+#include <sstream>
+#include <stdexcept>
+
+LayerStack LayerStack::from_spec(const string& spec, int input_dim) {
+    return build(spec, input_dim, nullopt);
+}
+
+LayerStack LayerStack::from_spec(const string& spec, int input_dim, uint64_t seed) {
+    return build(spec, input_dim, seed);
+}
+
+LayerStack LayerStack::build(const string& spec, int input_dim, optional<uint64_t> seed) {
+    LayerStack stack;
+    stringstream ss(spec);
+    string entry;
+    int dim = input_dim;
+    while (getline(ss, entry, ',')) {
+        size_t colon = entry.find(':');
+        if (colon == string::npos) {
+            throw invalid_argument("layer spec '" + entry + "' is not <type>:<output dim>");
+        }
+        string type = entry.substr(0, colon);
+        int out_dim = 0;
+        try {
+            out_dim = stoi(entry.substr(colon + 1));
+        } catch (const exception&) {
+            out_dim = 0;
+        }
+        if (out_dim <= 0) {
+            throw invalid_argument("layer spec '" + entry + "' has no positive output dim");
+        }
+
+        uint64_t layer_seed = seed ? derive_seed(*seed, stack.size()) : random_seed();
+        if (type == "gcn") stack.add_layer(unique_ptr<BaseLayer>(new GCNLayer(dim, out_dim, layer_seed)));
+        else if (type == "sage") stack.add_layer(unique_ptr<BaseLayer>(new GraphSAGELayer(dim, out_dim, layer_seed)));
+        else if (type == "gat") stack.add_layer(unique_ptr<BaseLayer>(new GATLayer(dim, out_dim, layer_seed)));
+        else throw invalid_argument("unknown layer type '" + type + "'");
+        dim = out_dim;
+    }
+    if (stack.size() == 0) {
+        throw invalid_argument("empty model spec");
+    }
+    return stack;
+}
+
+void LayerStack::add_layer(unique_ptr<BaseLayer> layer) {
+    if (!layers.empty() && layer->get_input_dim() != layers.back()->get_output_dim()) {
+        throw invalid_argument("layer " + to_string(layers.size()) + " expects " + to_string(layer->get_input_dim())
+                               + " input features, but the previous layer outputs "
+                               + to_string(layers.back()->get_output_dim()));
+    }
+    layers.push_back(std::move(layer));
+}
+
+vector<vector<float>> LayerStack::forward(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    vector<float>* densities
+) const {
+    if (densities) densities->clear();
+    if (layers.empty()) return node_features;
+
+    vector<vector<float>> features;
+    const vector<vector<float>>* input = &node_features;
+    for (auto& layer : layers) {
+        vector<vector<float>> output;
+        float density = 1.0f;
+        if (sparsity_threshold > 0.0f) {
+            density = feature_density(*input);
+            if (densities) densities->push_back(density);
+        }
+        if (density < sparsity_threshold) {
+            output = layer->forward(SparseFeatures::from_dense(*input), adjacency_list);
+        } else if (hub_splitting) {
+            output = layer->forward_split(*input, adjacency_list, hub_split);
+        } else {
+            output = layer->forward(*input, adjacency_list);
+        }
+        features = std::move(output);
+        input = &features;
+    }
+    return features;
+}
@@ -0,0 +1,71 @@
+// LayerStack.h
+
+#pragma once
+#include "BaseLayer.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+using namespace std;
+
+// LayerStack runs a sequence of GNN layers over one graph,
+// feeding the output of each layer into the next one.
+class LayerStack {
+public:
+    // suggested switch-over point: below this fraction of non-zero activations
+    // the sparse kernels beat the dense ones
+    static constexpr float kDefaultSparsityThreshold = 0.3f;
+
+    // Builds a stack from a model spec such as "gcn:16,sage:8,gat:4": a comma
+    // separated list of <layer type>:<output dim>, where the type is one of
+    // gcn, sage or gat. The first layer consumes input_dim features.
+    // Throws invalid_argument for a malformed spec.
+    static LayerStack from_spec(const string& spec, int input_dim);
+
+    // Same, with every layer initialised deterministically from 'seed'
+    // (layer l uses derive_seed(seed, l))
+    static LayerStack from_spec(const string& spec, int input_dim, uint64_t seed);
+
+    // Appends a layer; its input dimension must match the previous layer's output
+    // (throws invalid_argument otherwise)
+    void add_layer(unique_ptr<BaseLayer> layer);
+
+    size_t size() const { return layers.size(); }
+    BaseLayer& layer(size_t index) const { return *layers[index]; }
+
+    // dimensions of the stack's input and of its final output
+    int get_input_dim() const { return layers.empty() ? 0 : layers.front()->get_input_dim(); }
+    int get_output_dim() const { return layers.empty() ? 0 : layers.back()->get_output_dim(); }
+
+    // Enables activation-sparsity-aware propagation. Whenever the fraction of
+    // non-zero values fed into a layer is below 'threshold', the layer receives
+    // them as SparseFeatures and runs its sparse kernel instead of the dense one.
+    // The results are identical either way. 0 (the default) disables the check.
+    void set_sparsity_threshold(float threshold) { sparsity_threshold = threshold; }
+
+    // Enables degree-aware execution: dense layer inputs go through
+    // BaseLayer::forward_split with these options (sparse inputs keep the
+    // sparse kernels)
+    void set_hub_splitting(const HubSplitOptions& options) {
+        hub_split = options;
+        hub_splitting = true;
+    }
+
+    // Runs every layer in order and returns the output of the last one.
+    // Safe to call from several threads at once. If 'densities' is given and
+    // the sparsity check is enabled, it receives the input density of each layer.
+    vector<vector<float>> forward(
+        const vector<vector<float>>& node_features, // input feature matrix
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        vector<float>* densities = nullptr          // optional per-layer diagnostics
+    ) const;
+
+private:
+    static LayerStack build(const string& spec, int input_dim, optional<uint64_t> seed);
+
+    vector<unique_ptr<BaseLayer>> layers;
+    float sparsity_threshold = 0.0f;
+    bool hub_splitting = false;
+    HubSplitOptions hub_split;
+};
@@ -0,0 +1,66 @@
+// Loss.cpp
+
+#include "Loss.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+float softmax_cross_entropy(
+    const vector<vector<float>>& scores,
+    const vector<int>& labels,
+    vector<vector<float>>* grad
+) {
+    if (labels.size() != scores.size()) {
+        throw invalid_argument("softmax_cross_entropy: one label per node expected");
+    }
+
+    int labelled = 0;
+    for (int label : labels) {
+        if (label != kIgnoreLabel) labelled++;
+    }
+    if (grad) {
+        grad->assign(scores.size(), vector<float>());
+    }
+
+    double total = 0.0;
+    vector<float> probs;
+    for (size_t i = 0; i < scores.size(); i++) {
+        const vector<float>& row = scores[i];
+        int num_classes = row.size();
+        if (grad) (*grad)[i].assign(num_classes, 0.0f);
+        if (labels[i] == kIgnoreLabel) continue;
+        if (labels[i] < 0 || labels[i] >= num_classes) {
+            throw invalid_argument("softmax_cross_entropy: label out of range for node "
+                                   + to_string(i));
+        }
+
+        // stable log-softmax
+        float max_val = *max_element(row.begin(), row.end());
+        float sum_exp = 0.0f;
+        probs.resize(num_classes);
+        for (int c = 0; c < num_classes; c++) {
+            probs[c] = exp(row[c] - max_val);
+            sum_exp += probs[c];
+        }
+        total += log(sum_exp) - (row[labels[i]] - max_val);
+
+        if (grad) {
+            vector<float>& g = (*grad)[i];
+            for (int c = 0; c < num_classes; c++) {
+                g[c] = (probs[c] / sum_exp - (c == labels[i] ? 1.0f : 0.0f)) / labelled;
+            }
+        }
+    }
+    return labelled > 0 ? static_cast<float>(total / labelled) : 0.0f;
+}
+
+float accuracy(const vector<vector<float>>& scores, const vector<int>& labels) {
+    int labelled = 0, correct = 0;
+    for (size_t i = 0; i < scores.size() && i < labels.size(); i++) {
+        if (labels[i] == kIgnoreLabel || scores[i].empty()) continue;
+        labelled++;
+        int predicted = max_element(scores[i].begin(), scores[i].end()) - scores[i].begin();
+        if (predicted == labels[i]) correct++;
+    }
+    return labelled > 0 ? static_cast<float>(correct) / labelled : 0.0f;
+}
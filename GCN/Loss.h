@@ -0,0 +1,22 @@
+// Loss.h
+
+#pragma once
+#include <vector>
+using namespace std;
+
+// Label value for nodes that do not contribute to the loss (e.g. test nodes)
+const int kIgnoreLabel = -1;
+
+// Softmax cross-entropy over node scores:[number of nodes][number of classes].
+// labels[i] is the class of node i, or kIgnoreLabel. Returns the mean loss over
+// the labelled nodes (0 if there are none). If 'grad' is given it receives
+// dLoss/dScores with the same shape (zero rows for ignored nodes).
+// Throws invalid_argument for a label outside [0, number of classes).
+float softmax_cross_entropy(
+    const vector<vector<float>>& scores,
+    const vector<int>& labels,
+    vector<vector<float>>* grad = nullptr
+);
+
+// Fraction of labelled nodes whose highest score is their label
+float accuracy(const vector<vector<float>>& scores, const vector<int>& labels);
@@ -0,0 +1,223 @@
+// Numa.cpp
+
+#include "Numa.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sched.h>
+
+namespace {
+
+// Parses a kernel cpulist such as "0-3,8,10-11"
+vector<int> parse_cpulist(const string& text) {
+    vector<int> cpus;
+    stringstream ss(text);
+    string part;
+    while (getline(ss, part, ',')) {
+        if (part.empty()) continue;
+        size_t dash = part.find('-');
+        int first = stoi(part.substr(0, dash));
+        int last = (dash == string::npos) ? first : stoi(part.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+}  // namespace
+
+NumaTopology NumaTopology::single_node() {
+    NumaTopology topology;
+    vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        int n = max(1u, thread::hardware_concurrency());
+        for (int cpu = 0; cpu < n; cpu++) cpus.push_back(cpu);
+    }
+    topology.node_cpus.push_back(cpus);
+    return topology;
+}
+
+NumaTopology NumaTopology::detect() {
+    NumaTopology topology;
+    for (int node = 0; ; node++) {
+        ifstream cpulist("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if (!cpulist.is_open()) break;
+        string line;
+        getline(cpulist, line);
+        vector<int> cpus = parse_cpulist(line);
+        if (!cpus.empty()) {
+            topology.node_cpus.push_back(cpus); // memory-only nodes have no CPUs to pin to
+        }
+    }
+    if (topology.node_cpus.empty()) {
+        return single_node();
+    }
+    return topology;
+}
+
+bool pin_current_thread(const vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+PinnedThreadPool::PinnedThreadPool(const NumaTopology& topology) {
+    for (int n = 0; n < topology.num_nodes(); n++) {
+        int num_workers = topology.node_cpus[n].size();
+        for (int w = 0; w < num_workers; w++) {
+            threads.emplace_back(&PinnedThreadPool::worker_loop, this, n, w, num_workers,
+                                 topology.node_cpus[n]);
+        }
+    }
+}
+
+PinnedThreadPool::~PinnedThreadPool() {
+    {
+        lock_guard<mutex> lock(state_mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void PinnedThreadPool::worker_loop(int numa_node, int worker, int num_workers, const vector<int>& cpus) {
+    pin_current_thread(cpus); // unpinned threads still give correct results
+    uint64_t seen = 0;
+    while (true) {
+        const function<void(int, int, int)>* current;
+        {
+            unique_lock<mutex> lock(state_mutex);
+            start_cv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            current = job;
+        }
+        exception_ptr failure;
+        try {
+            (*current)(numa_node, worker, num_workers);
+        } catch (...) {
+            failure = current_exception();
+        }
+        lock_guard<mutex> lock(state_mutex);
+        if (failure && !error) error = failure;
+        if (--pending == 0) done_cv.notify_one();
+    }
+}
+
+void PinnedThreadPool::run(const function<void(int, int, int)>& fn) {
+    lock_guard<mutex> serial(run_mutex);
+    exception_ptr failure;
+    {
+        unique_lock<mutex> lock(state_mutex);
+        job = &fn;
+        error = nullptr;
+        pending = threads.size();
+        generation++;
+        start_cv.notify_all();
+        done_cv.wait(lock, [&] { return pending == 0; });
+        job = nullptr;
+        failure = error;
+    }
+    if (failure) rethrow_exception(failure);
+}
+
+NumaPlacement::NumaPlacement(const NumaTopology& topology, int num_graph_nodes)
+    : topo(topology), home(num_graph_nodes), rows(topology.num_nodes()),
+      pool(make_shared<PinnedThreadPool>(topology))
+{
+    // contiguous ranges proportional to the CPU count of each NUMA node
+    size_t total_cpus = 0;
+    for (const auto& cpus : topo.node_cpus) total_cpus += cpus.size();
+
+    int begin = 0;
+    size_t cpus_so_far = 0;
+    for (int n = 0; n < topo.num_nodes(); n++) {
+        cpus_so_far += topo.node_cpus[n].size();
+        int end = (n == topo.num_nodes() - 1)
+            ? num_graph_nodes
+            : static_cast<int>(static_cast<long long>(num_graph_nodes) * cpus_so_far / total_cpus);
+        for (int i = begin; i < end; i++) {
+            home[i] = n;
+            rows[n].push_back(i);
+        }
+        begin = end;
+    }
+}
+
+void NumaPlacement::place_rows(vector<vector<float>>& features) const {
+    run_pinned([&](int n, int w, int num_workers) {
+        const vector<int>& owned = rows[n];
+        for (size_t k = w; k < owned.size(); k += num_workers) {
+            vector<float>& row = features[owned[k]];
+            vector<float> local(row.begin(), row.end()); // allocated and touched here
+            row.swap(local);
+        }
+    });
+}
+
+vector<vector<float>> NumaPlacement::allocate(int dim) const {
+    vector<vector<float>> matrix(home.size());
+    run_pinned([&](int n, int w, int num_workers) {
+        const vector<int>& owned = rows[n];
+        for (size_t k = w; k < owned.size(); k += num_workers) {
+            matrix[owned[k]].assign(dim, 0.0f);
+        }
+    });
+    return matrix;
+}
+
+vector<vector<float>> NumaPlacement::forward(
+    BaseLayer& layer,
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list
+) const {
+    vector<vector<float>> out = allocate(layer.get_output_dim());
+    run_pinned([&](int n, int w, int num_workers) {
+        const vector<int>& owned = rows[n];
+        size_t begin = owned.size() * w / num_workers;
+        size_t end = owned.size() * (w + 1) / num_workers;
+        if (begin == end) return;
+        vector<int> chunk(owned.begin() + begin, owned.begin() + end);
+        layer.forward_rows(node_features, adjacency_list, chunk, out);
+    });
+    return out;
+}
+
+vector<vector<float>> NumaPlacement::forward(
+    const LayerStack& stack,
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list
+) const {
+    if (stack.size() == 0) return node_features;
+    vector<vector<float>> features = forward(stack.layer(0), node_features, adjacency_list);
+    for (size_t l = 1; l < stack.size(); l++) {
+        features = forward(stack.layer(l), features, adjacency_list);
+    }
+    return features;
+}
+
+NumaAccessStats NumaPlacement::access_stats(const vector<vector<int>>& adjacency_list) const {
+    NumaAccessStats stats;
+    for (size_t i = 0; i < adjacency_list.size(); i++) {
+        for (int j : adjacency_list[i]) {
+            if (home[j] == home[i]) stats.local_reads++;
+            else stats.remote_reads++;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,133 @@
+// Numa.h
+
+#pragma once
+#include "BaseLayer.h"
+#include "LayerStack.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// NumaTopology lists the CPUs of every NUMA node of the host.
+// When the host exposes no NUMA information it reports a single node
+// holding every CPU, so all NUMA-aware code degrades to plain threading.
+struct NumaTopology {
+    vector<vector<int>> node_cpus; // CPU ids per NUMA node
+
+    int num_nodes() const { return node_cpus.size(); }
+
+    // true when there is more than one node to place memory on
+    bool is_numa() const { return node_cpus.size() > 1; }
+
+    // Reads /sys/devices/system/node; falls back to one node on failure
+    static NumaTopology detect();
+
+    // A topology with one node holding the CPUs this process may run on
+    static NumaTopology single_node();
+};
+
+// Restricts the calling thread to the given CPUs (sched_setaffinity).
+// Returns false (leaving the thread unpinned) if the kernel refuses.
+bool pin_current_thread(const vector<int>& cpus);
+
+// PinnedThreadPool starts one thread per CPU of every NUMA node, pins each
+// to its node once, and reuses them for every job, so layer calls do not pay
+// for creating and pinning threads each time.
+class PinnedThreadPool {
+public:
+    explicit PinnedThreadPool(const NumaTopology& topology);
+    ~PinnedThreadPool();
+    PinnedThreadPool(const PinnedThreadPool&) = delete;
+    PinnedThreadPool& operator=(const PinnedThreadPool&) = delete;
+
+    // Calls job(numa_node, worker, num_workers) on every pinned thread and
+    // waits for all of them. Jobs from different callers run one at a time.
+    // The first exception thrown by a worker is rethrown here.
+    void run(const function<void(int, int, int)>& job);
+
+private:
+    vector<thread> threads;
+    mutex run_mutex;                 // serialises run()
+    mutex state_mutex;               // guards the fields below
+    condition_variable start_cv;     // workers wait here for the next generation
+    condition_variable done_cv;      // run() waits here for pending == 0
+    const function<void(int, int, int)>* job = nullptr;
+    uint64_t generation = 0;
+    int pending = 0;
+    bool stopping = false;
+    exception_ptr error;
+
+    void worker_loop(int numa_node, int worker, int num_workers, const vector<int>& cpus);
+};
+
+// Neighbour reads of one layer pass, split by whether the neighbour's row
+// lives on the reader's NUMA node
+struct NumaAccessStats {
+    size_t local_reads = 0;
+    size_t remote_reads = 0;
+
+    double local_ratio() const {
+        size_t total = local_reads + remote_reads;
+        return total == 0 ? 1.0 : static_cast<double>(local_reads) / total;
+    }
+};
+
+// NumaPlacement splits the graph nodes into contiguous ranges, one per NUMA
+// node (sized by the node's CPU count), and runs all work on a range with
+// threads pinned to that range's NUMA node (a PinnedThreadPool created with
+// the placement). Feature rows and layer outputs
+// are allocated and first-touched by those pinned threads, so the pages of a
+// row end up on the node that reads and writes it most.
+class NumaPlacement {
+public:
+    NumaPlacement(const NumaTopology& topology, int num_graph_nodes);
+
+    const NumaTopology& topology() const { return topo; }
+
+    // NUMA node owning a graph node
+    int home_of(int graph_node) const { return home[graph_node]; }
+
+    // graph nodes owned by a NUMA node
+    const vector<int>& rows_of(int numa_node) const { return rows[numa_node]; }
+
+    // Re-allocates every feature row on its home node (first touch by a
+    // pinned thread). Call once after reading the graph on a single thread.
+    void place_rows(vector<vector<float>>& features) const;
+
+    // Allocates a [num_graph_nodes][dim] zero matrix with rows on their home nodes
+    vector<vector<float>> allocate(int dim) const;
+
+    // Runs one layer with every NUMA node computing its own rows into a
+    // freshly placed output matrix
+    vector<vector<float>> forward(
+        BaseLayer& layer,
+        const vector<vector<float>>& node_features,
+        const vector<vector<int>>& adjacency_list
+    ) const;
+
+    // Runs every layer of a stack the same way
+    vector<vector<float>> forward(
+        const LayerStack& stack,
+        const vector<vector<float>>& node_features,
+        const vector<vector<int>>& adjacency_list
+    ) const;
+
+    // Counts local and remote neighbour reads of one aggregation pass
+    NumaAccessStats access_stats(const vector<vector<int>>& adjacency_list) const;
+
+private:
+    NumaTopology topo;
+    vector<int> home;          // home NUMA node per graph node
+    vector<vector<int>> rows;  // graph nodes per NUMA node
+
+    shared_ptr<PinnedThreadPool> pool; // shared by copies of the placement
+
+    // Calls fn(numa_node, worker, num_workers) on threads pinned to each NUMA node
+    void run_pinned(const function<void(int, int, int)>& fn) const { pool->run(fn); }
+};
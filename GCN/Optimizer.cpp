@@ -0,0 +1,82 @@
+// Optimizer.cpp
+
+#include "Optimizer.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Checks that the parameter and gradient lists line up
+void check_buffers(const vector<vector<float>*>& params, const vector<vector<float>*>& grads) {
+    if (params.size() != grads.size()) {
+        throw invalid_argument("optimizer: parameter and gradient lists differ in length");
+    }
+    for (size_t k = 0; k < params.size(); k++) {
+        if (params[k]->size() != grads[k]->size()) {
+            throw invalid_argument("optimizer: parameter and gradient buffers differ in size");
+        }
+    }
+}
+
+// Gives 'state' one zero buffer per parameter buffer (on the first step)
+void init_state(vector<vector<float>>& state, const vector<vector<float>*>& params) {
+    if (state.size() == params.size()) return;
+    state.clear();
+    for (const vector<float>* p : params) {
+        state.emplace_back(p->size(), 0.0f);
+    }
+}
+
+}  // namespace
+
+SGD::SGD(float learning_rate, float momentum, float weight_decay)
+    : learning_rate(learning_rate), momentum(momentum), weight_decay(weight_decay) {}
+
+void SGD::step(const vector<vector<float>*>& params, const vector<vector<float>*>& grads) {
+    check_buffers(params, grads);
+    if (momentum != 0.0f) {
+        init_state(velocity, params);
+    }
+
+    for (size_t k = 0; k < params.size(); k++) {
+        vector<float>& p = *params[k];
+        const vector<float>& g = *grads[k];
+        for (size_t i = 0; i < p.size(); i++) {
+            float grad = g[i] + weight_decay * p[i];
+            if (momentum != 0.0f) {
+                velocity[k][i] = momentum * velocity[k][i] + grad;
+                grad = velocity[k][i];
+            }
+            p[i] -= learning_rate * grad;
+        }
+    }
+}
+
+Adam::Adam(float learning_rate, float beta1, float beta2, float epsilon, float weight_decay)
+    : learning_rate(learning_rate), beta1(beta1), beta2(beta2),
+      epsilon(epsilon), weight_decay(weight_decay) {}
+
+void Adam::step(const vector<vector<float>*>& params, const vector<vector<float>*>& grads) {
+    check_buffers(params, grads);
+    init_state(m, params);
+    init_state(v, params);
+
+    steps++;
+    float correction1 = 1.0f - pow(beta1, static_cast<float>(steps));
+    float correction2 = 1.0f - pow(beta2, static_cast<float>(steps));
+
+    for (size_t k = 0; k < params.size(); k++) {
+        vector<float>& p = *params[k];
+        const vector<float>& g = *grads[k];
+        vector<float>& m_k = m[k];
+        vector<float>& v_k = v[k];
+        for (size_t i = 0; i < p.size(); i++) {
+            float grad = g[i] + weight_decay * p[i];
+            m_k[i] = beta1 * m_k[i] + (1.0f - beta1) * grad;
+            v_k[i] = beta2 * v_k[i] + (1.0f - beta2) * grad * grad;
+            float m_hat = m_k[i] / correction1;
+            float v_hat = v_k[i] / correction2;
+            p[i] -= learning_rate * m_hat / (sqrt(v_hat) + epsilon);
+        }
+    }
+}
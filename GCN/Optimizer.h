@@ -0,0 +1,58 @@
+// Optimizer.h
+
+#pragma once
+#include <vector>
+using namespace std;
+
+// Optimizers update flat parameter buffers (BaseLayer::parameters()) from the
+// matching gradient buffers (BaseLayer::gradients()). Per-parameter state is
+// keyed by position in the list, so pass the buffers in the same order on
+// every step.
+class Optimizer {
+public:
+    virtual ~Optimizer() {}
+
+    // Applies one update; params[k] and grads[k] must have the same size
+    virtual void step(
+        const vector<vector<float>*>& params,
+        const vector<vector<float>*>& grads
+    ) = 0;
+};
+
+// Stochastic gradient descent with optional momentum and L2 weight decay
+class SGD : public Optimizer {
+public:
+    explicit SGD(float learning_rate, float momentum = 0.0f, float weight_decay = 0.0f);
+
+    void step(
+        const vector<vector<float>*>& params,
+        const vector<vector<float>*>& grads
+    ) override;
+
+private:
+    float learning_rate;
+    float momentum;
+    float weight_decay;
+    vector<vector<float>> velocity; // momentum buffers, one per parameter buffer
+};
+
+// Adam (Kingma & Ba) with bias-corrected first and second moment estimates
+class Adam : public Optimizer {
+public:
+    explicit Adam(float learning_rate = 0.01f, float beta1 = 0.9f, float beta2 = 0.999f,
+                  float epsilon = 1e-8f, float weight_decay = 0.0f);
+
+    void step(
+        const vector<vector<float>*>& params,
+        const vector<vector<float>*>& grads
+    ) override;
+
+private:
+    float learning_rate;
+    float beta1, beta2;
+    float epsilon;
+    float weight_decay;
+    long long steps = 0;         // number of updates applied so far
+    vector<vector<float>> m;     // first moment, one per parameter buffer
+    vector<vector<float>> v;     // second moment, one per parameter buffer
+};
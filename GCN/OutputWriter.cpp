@@ -0,0 +1,312 @@
+#include "OutputWriter.h"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace OutputWriter {
+
+  namespace {
+
+    // longest std::to_chars output for a float plus a separator
+    const size_t kMaxFloatChars = 32;
+
+    bool host_is_little_endian() {
+      uint16_t probe = 1;
+      unsigned char first;
+      memcpy(&first, &probe, 1);
+      return first == 1;
+    }
+
+    void put_u32(BufferedFile& out, uint32_t v) {
+      unsigned char b[4];
+      for (int i = 0; i < 4; ++i) b[i] = static_cast<unsigned char>(v >> (8 * i));
+      out.write(b, 4);
+    }
+
+    void put_u64(BufferedFile& out, uint64_t v) {
+      unsigned char b[8];
+      for (int i = 0; i < 8; ++i) b[i] = static_cast<unsigned char>(v >> (8 * i));
+      out.write(b, 8);
+    }
+
+    // float32 values in little-endian byte order
+    void put_floats(BufferedFile& out, const float* values, size_t count) {
+      if (host_is_little_endian()) {
+        out.write(values, count * sizeof(float));
+        return;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        uint32_t bits;
+        memcpy(&bits, &values[i], 4);
+        put_u32(out, bits);
+      }
+    }
+
+    void write_raw_header(BufferedFile& out, RawType type, uint32_t ndim,
+                          uint64_t rows, uint64_t cols) {
+      out.write("GNNRAW1\0", 8);
+      put_u32(out, static_cast<uint32_t>(type));
+      put_u32(out, ndim);
+      put_u64(out, rows);
+      put_u64(out, cols);
+    }
+
+    // NumPy format 1.0 header; the total header is padded to 64 bytes
+    void write_npy_header(BufferedFile& out, const string& descr, const string& shape) {
+      string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': " + shape + ", }";
+      size_t unpadded = 10 + dict.size() + 1;
+      dict.append((64 - unpadded % 64) % 64, ' ');
+      dict.push_back('\n');
+
+      out.write("\x93NUMPY\x01\x00", 8);
+      uint16_t len = static_cast<uint16_t>(dict.size());
+      unsigned char len_bytes[2] = {static_cast<unsigned char>(len & 0xFF),
+                                    static_cast<unsigned char>(len >> 8)};
+      out.write(len_bytes, 2);
+      out.write(dict.data(), dict.size());
+    }
+
+    uint64_t get_u64(const unsigned char* b) {
+      uint64_t v = 0;
+      for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(b[i]) << (8 * i);
+      return v;
+    }
+
+    // float32 values stored in little-endian byte order
+    void get_floats(const unsigned char* bytes, float* values, size_t count) {
+      if (host_is_little_endian()) {
+        memcpy(values, bytes, count * sizeof(float));
+        return;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        uint32_t bits = 0;
+        for (int k = 0; k < 4; ++k) bits |= static_cast<uint32_t>(bytes[4 * i + k]) << (8 * k);
+        memcpy(&values[i], &bits, 4);
+      }
+    }
+
+    // Extracts rows and cols from a NumPy header dict such as
+    // "{'descr': '<f4', 'fortran_order': False, 'shape': (3, 4), }"
+    void parse_npy_header(const string& dict, const string& path, uint64_t& rows, uint64_t& cols) {
+      if (dict.find("'descr': '<f4'") == string::npos ||
+          dict.find("'fortran_order': False") == string::npos) {
+        throw runtime_error(path + ": expected a C-order float32 .npy file");
+      }
+      size_t open = dict.find('(', dict.find("'shape':"));
+      size_t close = dict.find(')', open);
+      if (open == string::npos || close == string::npos) {
+        throw runtime_error(path + ": malformed .npy shape");
+      }
+      vector<uint64_t> dims;
+      string shape = dict.substr(open + 1, close - open - 1);
+      for (size_t pos = 0; pos < shape.size();) {
+        size_t comma = shape.find(',', pos);
+        if (comma == string::npos) comma = shape.size();
+        string item = shape.substr(pos, comma - pos);
+        if (item.find_first_not_of(' ') != string::npos) dims.push_back(stoull(item));
+        pos = comma + 1;
+      }
+      if (dims.size() != 2) throw runtime_error(path + ": expected a 2-D .npy array");
+      rows = dims[0];
+      cols = dims[1];
+    }
+
+    // formats one float followed by 'separator' straight into the file buffer
+    void put_text_float(BufferedFile& out, float value, char separator) {
+      char* p = out.reserve(kMaxFloatChars);
+      to_chars_result r = to_chars(p, p + kMaxFloatChars - 1, value);
+      *r.ptr = separator;
+      out.commit(r.ptr + 1 - p);
+    }
+
+  }  // namespace
+
+  Format parse_format(const string& name) {
+    if (name == "npy") return Format::Npy;
+    if (name == "raw") return Format::Raw;
+    if (name == "text") return Format::Text;
+    throw invalid_argument("unknown output format '" + name + "' (expected npy, raw or text)");
+  }
+
+  string extension(Format format) {
+    switch (format) {
+      case Format::Npy: return ".npy";
+      case Format::Raw: return ".bin";
+      case Format::Text: return ".txt";
+    }
+    return "";
+  }
+
+  //──────────────────────────────────────────────────────────────────────────
+  // BufferedFile
+  //──────────────────────────────────────────────────────────────────────────
+
+  BufferedFile::BufferedFile(const string& path) : path(path), buffer(kBufferSize) {
+    file = fopen(path.c_str(), "wb");
+    if (!file) throw runtime_error("cannot open " + path + " for writing");
+    setvbuf(file, nullptr, _IONBF, 0); // we do our own buffering
+  }
+
+  BufferedFile::~BufferedFile() {
+    if (!file) return;
+    try {
+      flush();
+    } catch (const exception&) {
+      // destructors must not throw; callers wanting errors call flush() first
+    }
+    fclose(file);
+  }
+
+  void BufferedFile::write_through(const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, file) != size) {
+      throw runtime_error("write to " + path + " failed");
+    }
+  }
+
+  void BufferedFile::flush() {
+    write_through(buffer.data(), used);
+    used = 0;
+  }
+
+  void BufferedFile::write(const void* data, size_t size) {
+    if (used + size > buffer.size()) {
+      flush();
+      if (size >= buffer.size()) {
+        write_through(data, size);
+        return;
+      }
+    }
+    memcpy(buffer.data() + used, data, size);
+    used += size;
+  }
+
+  char* BufferedFile::reserve(size_t size) {
+    if (used + size > buffer.size()) flush();
+    return buffer.data() + used;
+  }
+
+  void BufferedFile::commit(size_t size) {
+    used += size;
+  }
+
+  //──────────────────────────────────────────────────────────────────────────
+  // Writers
+  //──────────────────────────────────────────────────────────────────────────
+
+  void write_embeddings(const string& path, const vector<vector<float>>& features, Format format) {
+    BufferedFile out(path);
+    uint64_t rows = features.size();
+    uint64_t cols = features.empty() ? 0 : features[0].size();
+
+    switch (format) {
+      case Format::Npy:
+        write_npy_header(out, "<f4", "(" + to_string(rows) + ", " + to_string(cols) + ")");
+        for (const auto& row : features) put_floats(out, row.data(), row.size());
+        break;
+      case Format::Raw:
+        write_raw_header(out, RawType::Float32, 2, rows, cols);
+        for (const auto& row : features) put_floats(out, row.data(), row.size());
+        break;
+      case Format::Text:
+        for (const auto& row : features) {
+          for (size_t d = 0; d < row.size(); ++d) {
+            put_text_float(out, row[d], d + 1 == row.size() ? '\n' : ' ');
+          }
+          if (row.empty()) out.write("\n", 1);
+        }
+        break;
+    }
+    out.flush();
+  }
+
+  void write_scores(const string& path, const vector<float>& scores, Format format) {
+    BufferedFile out(path);
+    switch (format) {
+      case Format::Npy:
+        write_npy_header(out, "<f4", "(" + to_string(scores.size()) + ",)");
+        put_floats(out, scores.data(), scores.size());
+        break;
+      case Format::Raw:
+        write_raw_header(out, RawType::Float32, 1, scores.size(), 1);
+        put_floats(out, scores.data(), scores.size());
+        break;
+      case Format::Text:
+        for (float s : scores) put_text_float(out, s, '\n');
+        break;
+    }
+    out.flush();
+  }
+
+  void write_binary(const string& path, const OutputConverter::BinaryVector& labels, Format format) {
+    BufferedFile out(path);
+    switch (format) {
+      case Format::Npy: {
+        write_npy_header(out, "|b1", "(" + to_string(labels.size()) + ",)");
+        for (bool b : labels) {
+          char c = b ? 1 : 0;
+          out.write(&c, 1);
+        }
+        break;
+      }
+      case Format::Raw: {
+        write_raw_header(out, RawType::Bits, 1, labels.size(), 1);
+        unsigned char byte = 0;
+        for (size_t i = 0; i < labels.size(); ++i) {
+          if (labels[i]) byte |= static_cast<unsigned char>(1u << (i % 8));
+          if (i % 8 == 7) {
+            out.write(&byte, 1);
+            byte = 0;
+          }
+        }
+        if (labels.size() % 8 != 0) out.write(&byte, 1);
+        break;
+      }
+      case Format::Text:
+        for (bool b : labels) out.write(b ? "1\n" : "0\n", 2);
+        break;
+    }
+    out.flush();
+  }
+
+  //──────────────────────────────────────────────────────────────────────────
+  // Readers
+  //──────────────────────────────────────────────────────────────────────────
+
+  vector<vector<float>> read_embeddings(const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in) throw runtime_error("cannot open " + path + " for reading");
+    string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(bytes.data());
+
+    uint64_t rows = 0, cols = 0;
+    size_t payload = 0;
+    if (bytes.size() >= 10 && bytes.compare(0, 6, "\x93NUMPY") == 0) {
+      size_t header_len = data[8] | (static_cast<size_t>(data[9]) << 8);
+      if (data[6] != 1 || bytes.size() < 10 + header_len) {
+        throw runtime_error(path + ": unsupported or truncated .npy header");
+      }
+      parse_npy_header(bytes.substr(10, header_len), path, rows, cols);
+      payload = 10 + header_len;
+    } else if (bytes.size() >= 32 && bytes.compare(0, 8, string("GNNRAW1\0", 8)) == 0) {
+      if (data[8] != static_cast<unsigned char>(RawType::Float32) || data[12] != 2) {
+        throw runtime_error(path + ": expected a 2-D float32 raw file");
+      }
+      rows = get_u64(data + 16);
+      cols = get_u64(data + 24);
+      payload = 32;
+    } else {
+      throw runtime_error(path + ": not an .npy or raw embedding file");
+    }
+
+    if (bytes.size() - payload < rows * cols * sizeof(float)) {
+      throw runtime_error(path + ": truncated payload");
+    }
+    vector<vector<float>> features(rows, vector<float>(cols));
+    for (uint64_t r = 0; r < rows; ++r) {
+      get_floats(data + payload + r * cols * sizeof(float), features[r].data(), cols);
+    }
+    return features;
+  }
+
+} // namespace OutputWriter
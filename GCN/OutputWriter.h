@@ -0,0 +1,80 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Aggregator.h"  // NodeScores, EdgeScores, BinaryVector
+
+using namespace std;
+
+// Writers for inference results that avoid per-value stream formatting.
+// Every writer goes through a large buffer and throws runtime_error if the
+// file cannot be created or written.
+namespace OutputWriter {
+
+  enum class Format {
+    Npy,   // NumPy .npy (float32 '<f4', bools as '|b1'), loadable with np.load
+    Raw,   // little-endian binary with a small fixed header (see below)
+    Text   // buffered text, shortest round-trip floats via std::to_chars
+  };
+
+  // Raw format layout (all integers little-endian):
+  //   char[8]  magic "GNNRAW1\0"
+  //   uint32   element type: 0 = float32, 1 = bit-packed bool (LSB first)
+  //   uint32   number of dimensions (1 or 2)
+  //   uint64   dims[2] (rows, cols; cols = 1 for vectors)
+  //   payload  rows * cols float32, or ceil(rows / 8) bytes of packed bits
+  enum class RawType : uint32_t { Float32 = 0, Bits = 1 };
+
+  // Parses "npy", "raw" or "text"; throws invalid_argument otherwise
+  Format parse_format(const string& name);
+
+  // file extension (with dot) used for a format
+  string extension(Format format);
+
+  // [n_nodes][dim] node embeddings; text writes one row per line
+  void write_embeddings(const string& path, const vector<vector<float>>& features, Format format);
+
+  // per-node or per-edge scores; text writes one value per line
+  void write_scores(const string& path, const vector<float>& scores, Format format);
+
+  // binary labels (e.g. toEdgeBinary); raw packs 8 labels per byte,
+  // text writes one 0/1 per line
+  void write_binary(const string& path, const OutputConverter::BinaryVector& labels, Format format);
+
+  // Reads back a [rows][cols] float32 matrix written by write_embeddings in
+  // Npy or Raw format (the format is taken from the file's magic bytes).
+  // Throws runtime_error for unreadable, truncated or non-float32 files.
+  vector<vector<float>> read_embeddings(const string& path);
+
+  // Append-only file with a large user-space buffer; big payloads bypass the buffer
+  class BufferedFile {
+  public:
+    static constexpr size_t kBufferSize = 4 << 20;
+
+    explicit BufferedFile(const string& path);
+    ~BufferedFile();
+    BufferedFile(const BufferedFile&) = delete;
+    BufferedFile& operator=(const BufferedFile&) = delete;
+
+    void write(const void* data, size_t size);
+    void flush();
+
+    // reserves 'size' bytes at the end of the buffer for in-place formatting
+    char* reserve(size_t size);
+    void commit(size_t size);
+
+  private:
+    FILE* file;
+    string path;
+    vector<char> buffer;
+    size_t used = 0;
+
+    void write_through(const void* data, size_t size);
+  };
+
+} // namespace OutputWriter
+
+#endif // OUTPUT_WRITER_H
@@ -0,0 +1,73 @@
+// Parallel.h
+
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Number of worker threads to use when the caller does not specify one
+inline int default_thread_count() {
+    unsigned int n = thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+// Splits [begin, end) into num_threads contiguous chunks and calls
+// fn(chunk_begin, chunk_end, thread_index) for each chunk on its own thread.
+// The chunking depends only on the range and num_threads, never on timing.
+// Runs inline when there is a single thread or the range is tiny.
+template <typename Fn>
+void parallel_for(long long begin, long long end, int num_threads, Fn fn) {
+    long long count = end - begin;
+    if (count <= 0) return;
+    num_threads = static_cast<int>(max(1LL, min<long long>(num_threads, count)));
+    if (num_threads == 1) {
+        fn(begin, end, 0);
+        return;
+    }
+
+    vector<thread> workers;
+    workers.reserve(num_threads - 1);
+    long long chunk = count / num_threads, extra = count % num_threads;
+    long long chunk_begin = begin;
+    for (int t = 0; t < num_threads; t++) {
+        long long chunk_end = chunk_begin + chunk + (t < extra ? 1 : 0);
+        if (t == num_threads - 1) {
+            fn(chunk_begin, chunk_end, t); // last chunk on the calling thread
+        } else {
+            workers.emplace_back(fn, chunk_begin, chunk_end, t);
+        }
+        chunk_begin = chunk_end;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Exclusive prefix sum of 'counts' into 'offsets' (resized to counts.size() + 1,
+// offsets.back() is the total). Each thread sums one chunk, the chunk totals
+// are scanned serially, then each thread writes the offsets of its chunk.
+template <typename T, typename U>
+void parallel_prefix_sum(const vector<T>& counts, vector<U>& offsets, int num_threads) {
+    long long n = counts.size();
+    offsets.assign(n + 1, 0);
+    num_threads = static_cast<int>(max(1LL, min<long long>(num_threads, n)));
+    vector<U> chunk_total(num_threads + 1, 0);
+
+    parallel_for(0, n, num_threads, [&](long long begin, long long end, int t) {
+        U sum = 0;
+        for (long long i = begin; i < end; i++) sum += counts[i];
+        chunk_total[t + 1] = sum;
+    });
+    for (int t = 1; t <= num_threads; t++) {
+        chunk_total[t] += chunk_total[t - 1];
+    }
+    parallel_for(0, n, num_threads, [&](long long begin, long long end, int t) {
+        U running = chunk_total[t];
+        for (long long i = begin; i < end; i++) {
+            offsets[i] = running;
+            running += counts[i];
+        }
+    });
+    offsets[n] = chunk_total[num_threads];
+}
@@ -0,0 +1,435 @@
+// Partition.cpp
+
+#include "Partition.h"
+#include "GraphReader.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+
+using Clock = chrono::steady_clock;
+
+namespace {
+
+double seconds_since(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Breadth-first order over all components, starting each component at its lowest id
+vector<int> bfs_order(const vector<vector<int>>& adjacency_list) {
+    int n_nodes = adjacency_list.size();
+    vector<int> order;
+    order.reserve(n_nodes);
+    vector<char> visited(n_nodes, 0);
+    queue<int> frontier;
+    for (int start = 0; start < n_nodes; start++) {
+        if (visited[start]) continue;
+        visited[start] = 1;
+        frontier.push(start);
+        while (!frontier.empty()) {
+            int v = frontier.front();
+            frontier.pop();
+            order.push_back(v);
+            for (int u : adjacency_list[v]) {
+                if (!visited[u]) {
+                    visited[u] = 1;
+                    frontier.push(u);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+// Position of every node among the nodes of its part (owned nodes keep
+// their global order inside each part). Throws invalid_argument if part_of
+// does not match the graph.
+vector<int> local_indices(const vector<int>& part_of, int num_parts, int num_nodes) {
+    if (static_cast<int>(part_of.size()) != num_nodes) {
+        throw invalid_argument("build_partitions: one part id per node expected");
+    }
+    vector<int> local_index(num_nodes);
+    vector<int> next(num_parts, 0);
+    for (int v = 0; v < num_nodes; v++) {
+        int part = part_of[v];
+        if (part < 0 || part >= num_parts) {
+            throw invalid_argument("build_partitions: part id out of range");
+        }
+        local_index[v] = next[part]++;
+    }
+    return local_index;
+}
+
+// Fills the halo (ascending global ids), the local neighbour lists and the
+// owned degrees of p from p.owned; neighbors_of(k) gives the global neighbour
+// list of owned node k. Halo degrees are left at zero for the caller.
+template <typename NeighborsOf>
+void localize(
+    GraphPartition& p,
+    const vector<int>& part_of,
+    const vector<int>& local_index,
+    int part,
+    NeighborsOf neighbors_of
+) {
+    int n_owned = p.num_owned();
+    for (int k = 0; k < n_owned; k++) {
+        for (int u : neighbors_of(k)) {
+            if (part_of[u] != part) p.halo.push_back(u);
+        }
+    }
+    sort(p.halo.begin(), p.halo.end());
+    p.halo.erase(unique(p.halo.begin(), p.halo.end()), p.halo.end());
+
+    unordered_map<int, int> halo_local; // global id -> local id of halo nodes
+    for (size_t h = 0; h < p.halo.size(); h++) {
+        int v = p.halo[h];
+        halo_local.emplace(v, n_owned + static_cast<int>(h));
+        p.halo_owner.push_back(part_of[v]);
+        p.halo_owner_index.push_back(local_index[v]);
+    }
+
+    // halo nodes: no neighbours of their own, only their true degree
+    p.local_adjacency.assign(p.num_local(), vector<int>());
+    p.degree.assign(p.num_local(), 0);
+    for (int k = 0; k < n_owned; k++) {
+        const vector<int>& neighbors = neighbors_of(k);
+        vector<int>& local = p.local_adjacency[k];
+        local.reserve(neighbors.size());
+        p.degree[k] = neighbors.size();
+        for (int u : neighbors) {
+            local.push_back(part_of[u] == part ? local_index[u] : halo_local[u]);
+        }
+    }
+}
+
+GraphPartition build_one_partition(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    const vector<int>& local_index,
+    int part
+) {
+    GraphPartition p;
+    for (int v = 0; v < static_cast<int>(adjacency_list.size()); v++) {
+        if (part_of[v] == part) p.owned.push_back(v);
+    }
+    localize(p, part_of, local_index, part, [&](int k) -> const vector<int>& { return adjacency_list[p.owned[k]]; });
+    for (size_t h = 0; h < p.halo.size(); h++) {
+        p.degree[p.num_owned() + h] = adjacency_list[p.halo[h]].size();
+    }
+    return p;
+}
+
+}  // namespace
+
+double PartitionMetrics::imbalance() const {
+    if (part_sizes.empty()) return 1.0;
+    long long total = 0;
+    int largest = 0;
+    for (int size : part_sizes) {
+        total += size;
+        largest = max(largest, size);
+    }
+    if (total == 0) return 1.0;
+    return largest / (static_cast<double>(total) / part_sizes.size());
+}
+
+vector<int> partition_graph(
+    const vector<vector<int>>& adjacency_list,
+    int num_parts,
+    const PartitionOptions& options
+) {
+    if (num_parts < 1) {
+        throw invalid_argument("partition_graph: need at least one part");
+    }
+    int n_nodes = adjacency_list.size();
+    vector<int> part_of(n_nodes, 0);
+    if (num_parts == 1 || n_nodes == 0) return part_of;
+
+    // Initial assignment: equal runs of the BFS order
+    vector<int> order = bfs_order(adjacency_list);
+    vector<int> part_size(num_parts, 0);
+    for (int k = 0; k < n_nodes; k++) {
+        int part = static_cast<int>(static_cast<long long>(k) * num_parts / n_nodes);
+        part_of[order[k]] = part;
+        part_size[part]++;
+    }
+
+    // Label propagation under a size cap
+    int capacity = max(static_cast<int>(ceil(static_cast<double>(n_nodes) / num_parts * options.max_imbalance)),
+                       (n_nodes + num_parts - 1) / num_parts);
+    vector<int> neighbor_count(num_parts, 0);
+    vector<int> touched;
+    for (int iteration = 0; iteration < options.max_iterations; iteration++) {
+        int moved = 0;
+        for (int v : order) {
+            int current = part_of[v];
+            if (part_size[current] == 1) continue; // never empty a part
+
+            touched.clear();
+            for (int u : adjacency_list[v]) {
+                int part = part_of[u];
+                if (neighbor_count[part]++ == 0) touched.push_back(part);
+            }
+
+            int best = current;
+            int best_count = neighbor_count[current];
+            for (int part : touched) {
+                if (neighbor_count[part] > best_count && part_size[part] < capacity) {
+                    best = part;
+                    best_count = neighbor_count[part];
+                }
+            }
+            for (int part : touched) {
+                neighbor_count[part] = 0;
+            }
+
+            if (best != current) {
+                part_of[v] = best;
+                part_size[current]--;
+                part_size[best]++;
+                moved++;
+            }
+        }
+        if (moved == 0) break;
+    }
+    return part_of;
+}
+
+PartitionMetrics evaluate_partition(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+) {
+    PartitionMetrics metrics;
+    metrics.part_sizes.assign(num_parts, 0);
+    int n_nodes = adjacency_list.size();
+
+    // halo of a part = distinct foreign neighbours of its nodes
+    vector<int> last_seen(n_nodes, -1);
+    vector<vector<int>> nodes_of(num_parts);
+    for (int v = 0; v < n_nodes; v++) {
+        metrics.part_sizes[part_of[v]]++;
+        nodes_of[part_of[v]].push_back(v);
+    }
+    for (int part = 0; part < num_parts; part++) {
+        for (int v : nodes_of[part]) {
+            for (int u : adjacency_list[v]) {
+                metrics.total_edges++;
+                if (part_of[u] == part) continue;
+                metrics.cut_edges++;
+                if (last_seen[u] != part) {
+                    last_seen[u] = part;
+                    metrics.halo_nodes++;
+                }
+            }
+        }
+    }
+    return metrics;
+}
+
+vector<vector<int>> partition_halos(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+) {
+    vector<vector<int>> halos(num_parts);
+    int num_nodes = adjacency_list.size();
+    for (int v = 0; v < num_nodes; v++) {
+        for (int u : adjacency_list[v]) {
+            if (part_of[u] != part_of[v]) halos[part_of[v]].push_back(u);
+        }
+    }
+    for (vector<int>& halo : halos) {
+        sort(halo.begin(), halo.end());
+        halo.erase(unique(halo.begin(), halo.end()), halo.end());
+    }
+    return halos;
+}
+
+vector<vector<float>> gather_rows(const GraphPartition& part, const vector<vector<float>>& node_features) {
+    vector<vector<float>> local;
+    local.reserve(part.num_local());
+    for (int v : part.owned) local.push_back(node_features[v]);
+    for (int v : part.halo) local.push_back(node_features[v]);
+    return local;
+}
+
+vector<GraphPartition> build_partitions(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+) {
+    vector<int> local_index = local_indices(part_of, num_parts, adjacency_list.size());
+    vector<GraphPartition> parts(num_parts);
+    for (int part = 0; part < num_parts; part++) {
+        parts[part] = build_one_partition(adjacency_list, part_of, local_index, part);
+    }
+    return parts;
+}
+
+GraphPartition build_partition(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts,
+    int part
+) {
+    vector<int> local_index = local_indices(part_of, num_parts, adjacency_list.size());
+    return build_one_partition(adjacency_list, part_of, local_index, part);
+}
+
+GraphPartition load_partition(
+    const string& graph_file,
+    const vector<int>& part_of,
+    int num_parts,
+    int part,
+    vector<vector<float>>& local_features
+) {
+    ifstream in(graph_file);
+    if (!in) throw runtime_error("load_partition: cannot open " + graph_file);
+    GraphFileHeader header = read_graph_header(in);
+    vector<int> local_index = local_indices(part_of, num_parts, header.num_nodes);
+
+    // pass 1: the owned nodes' neighbour lists (global ids, file order)
+    GraphPartition p;
+    for (int v = 0; v < header.num_nodes; v++) {
+        if (part_of[v] == part) p.owned.push_back(v);
+    }
+    vector<vector<int>> neighbors(p.num_owned());
+    scan_graph_body(in, header, nullptr, [&](int src, int dst) {
+        if (part_of[src] == part) neighbors[local_index[src]].push_back(dst);
+        if (part_of[dst] == part) neighbors[local_index[dst]].push_back(src);
+    });
+    localize(p, part_of, local_index, part, [&](int k) -> const vector<int>& { return neighbors[k]; });
+    neighbors = vector<vector<int>>();
+
+    // pass 2: features of the local nodes and the degrees of the halo nodes
+    unordered_map<int, int> halo_local;
+    for (size_t h = 0; h < p.halo.size(); h++) {
+        halo_local.emplace(p.halo[h], p.num_owned() + static_cast<int>(h));
+    }
+    auto local_id = [&](int v) {
+        if (part_of[v] == part) return local_index[v];
+        auto it = halo_local.find(v);
+        return it == halo_local.end() ? -1 : it->second;
+    };
+    in.clear();
+    in.seekg(0);
+    read_graph_header(in);
+    local_features.assign(p.num_local(), vector<float>(header.num_features, 0.0f));
+    scan_graph_body(in, header,
+        [&](int node, const vector<float>& features) {
+            int k = local_id(node);
+            if (k >= 0) local_features[k] = features;
+        },
+        [&](int src, int dst) {
+            for (int v : {src, dst}) {
+                int k = local_id(v);
+                if (k >= p.num_owned()) p.degree[k]++;
+            }
+        });
+    return p;
+}
+
+PartitionedExecutor::PartitionedExecutor(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+) : num_nodes(adjacency_list.size()),
+    parts(build_partitions(adjacency_list, part_of, num_parts)),
+    owned_rows(num_parts) {
+    for (int part = 0; part < num_parts; part++) {
+        owned_rows[part].resize(parts[part].num_owned());
+        for (int k = 0; k < parts[part].num_owned(); k++) {
+            owned_rows[part][k] = k;
+        }
+    }
+}
+
+vector<vector<float>> PartitionedExecutor::forward(
+    BaseLayer& layer,
+    const vector<vector<float>>& node_features,
+    HaloExchangeStats* stats
+) const {
+    return run({&layer}, node_features, stats);
+}
+
+vector<vector<float>> PartitionedExecutor::forward(
+    const LayerStack& stack,
+    const vector<vector<float>>& node_features,
+    HaloExchangeStats* stats
+) const {
+    vector<BaseLayer*> layers;
+    for (size_t l = 0; l < stack.size(); l++) {
+        layers.push_back(&stack.layer(l));
+    }
+    return run(layers, node_features, stats);
+}
+
+vector<vector<float>> PartitionedExecutor::run(
+    const vector<BaseLayer*>& layers,
+    const vector<vector<float>>& node_features,
+    HaloExchangeStats* stats
+) const {
+    int n_parts = parts.size();
+    int num_threads = min(n_parts, default_thread_count());
+    if (stats) *stats = HaloExchangeStats();
+
+    // local input matrices: owned rows then halo rows
+    vector<vector<vector<float>>> local(n_parts);
+    parallel_for(0, n_parts, num_threads, [&](long long begin, long long end, int) {
+        for (long long part = begin; part < end; part++) {
+            local[part] = gather_rows(parts[part], node_features);
+        }
+    });
+
+    vector<vector<vector<float>>> next(n_parts);
+    for (size_t l = 0; l < layers.size(); l++) {
+        BaseLayer* layer = layers[l];
+        // each part computes its own rows
+        Clock::time_point start = Clock::now();
+        parallel_for(0, n_parts, num_threads, [&](long long begin, long long end, int) {
+            for (long long part = begin; part < end; part++) {
+                next[part].assign(parts[part].num_local(), vector<float>());
+                const GraphPartition& p = parts[part];
+                layer->forward_local_rows(local[part], p.local_adjacency, p.degree, owned_rows[part], next[part]);
+            }
+        });
+        if (stats) stats->compute_seconds += seconds_since(start);
+
+        // refresh halo rows from their owners (owned rows are only read here);
+        // the last layer's halo rows are never read
+        start = Clock::now();
+        long long rows = 0;
+        if (l + 1 < layers.size()) parallel_for(0, n_parts, num_threads, [&](long long begin, long long end, int) {
+            for (long long part = begin; part < end; part++) {
+                const GraphPartition& p = parts[part];
+                for (size_t h = 0; h < p.halo.size(); h++) {
+                    next[part][p.num_owned() + h] = next[p.halo_owner[h]][p.halo_owner_index[h]];
+                }
+            }
+        });
+        if (l + 1 < layers.size()) {
+            for (const GraphPartition& p : parts) rows += p.halo.size();
+        }
+        if (stats) {
+            stats->exchange_seconds += seconds_since(start);
+            stats->rows_exchanged.push_back(rows);
+            stats->bytes_exchanged.push_back(rows * layer->get_output_dim() * static_cast<long long>(sizeof(float)));
+        }
+        swap(local, next);
+    }
+
+    // gather owned rows into the global matrix
+    vector<vector<float>> output(num_nodes);
+    for (int part = 0; part < n_parts; part++) {
+        const GraphPartition& p = parts[part];
+        for (int k = 0; k < p.num_owned(); k++) {
+            output[p.owned[k]] = std::move(local[part][k]);
+        }
+    }
+    return output;
+}
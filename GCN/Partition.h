@@ -0,0 +1,158 @@
+// Partition.h
+
+#pragma once
+#include "BaseLayer.h"
+#include "LayerStack.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Settings of the label-propagation partitioner
+struct PartitionOptions {
+    float max_imbalance = 1.03f; // largest allowed part size relative to the average
+    int max_iterations = 20;     // label-propagation sweeps (stops early once no node moves)
+};
+
+// Quality of a partition. Edges are counted as adjacency entries, so an
+// undirected edge stored in both lists counts twice in both totals.
+struct PartitionMetrics {
+    vector<int> part_sizes;     // owned nodes per part
+    long long cut_edges = 0;    // entries whose endpoints lie in different parts
+    long long total_edges = 0;  // all adjacency entries
+    long long halo_nodes = 0;   // sum of the halo sizes of all parts
+
+    double cut_fraction() const {
+        return total_edges == 0 ? 0.0 : static_cast<double>(cut_edges) / total_edges;
+    }
+
+    // largest part size divided by the average part size (1.0 = perfectly balanced)
+    double imbalance() const;
+};
+
+// Splits the nodes into num_parts parts and returns the part of every node.
+// Nodes are first cut into equal runs of a breadth-first order (so parts start
+// out connected), then label propagation moves each node to the part holding
+// most of its neighbours as long as that part stays under the size cap.
+// Deterministic for a given graph. Throws invalid_argument if num_parts < 1.
+vector<int> partition_graph(
+    const vector<vector<int>>& adjacency_list,
+    int num_parts,
+    const PartitionOptions& options = PartitionOptions()
+);
+
+// Edge cut, balance and halo size of an assignment
+PartitionMetrics evaluate_partition(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+);
+
+// One part of a partitioned graph with its own local numbering:
+// local ids [0, owned.size()) are the part's own nodes in ascending global id,
+// followed by the halo (nodes of other parts adjacent to an owned node), also
+// in ascending global id. The numbering depends only on the graph and part_of.
+struct GraphPartition {
+    vector<int> owned;                    // global id of each owned node
+    vector<int> halo;                     // global id of each halo node
+    vector<int> halo_owner;               // part owning each halo node
+    vector<int> halo_owner_index;         // local id of each halo node in its owning part
+    vector<vector<int>> local_adjacency;  // neighbour lists in local ids, [owned + halo] (halo lists empty)
+    vector<int> degree;                   // global degree of each local node, [owned + halo]
+
+    int num_owned() const { return static_cast<int>(owned.size()); }
+    int num_local() const { return static_cast<int>(owned.size() + halo.size()); }
+};
+
+// Halo of every part, ascending global ids (the halo lists build_partitions
+// would produce, without building the local graphs)
+vector<vector<int>> partition_halos(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+);
+
+// Builds the local graph of every part (see PartitionedExecutor for how the
+// halo is handled). Throws invalid_argument if part_of does not match the graph.
+vector<GraphPartition> build_partitions(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts
+);
+
+// Builds the local graph of one part only; equal to build_partitions(...)[part]
+GraphPartition build_partition(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_parts,
+    int part
+);
+
+// Streams one part straight from a graph file (graph_data.txt format) without
+// loading the whole graph: the first pass collects the owned nodes' neighbour
+// lists, the second the features of the local nodes (into local_features,
+// [owned + halo][features]) and the halo degrees. Returns the same partition
+// as build_partition on the loaded graph. Throws runtime_error if the file
+// cannot be read, invalid_argument if part_of does not match it.
+GraphPartition load_partition(
+    const string& graph_file,
+    const vector<int>& part_of,
+    int num_parts,
+    int part,
+    vector<vector<float>>& local_features
+);
+
+// Input rows of a part's local nodes (owned, then halo) from the global feature matrix
+vector<vector<float>> gather_rows(const GraphPartition& part, const vector<vector<float>>& node_features);
+
+// Per-layer halo traffic and timing of a partitioned forward pass
+struct HaloExchangeStats {
+    vector<long long> rows_exchanged;  // halo rows copied after each layer (0 after the last)
+    vector<long long> bytes_exchanged; // the same in bytes
+    double compute_seconds = 0.0;      // time in the layers
+    double exchange_seconds = 0.0;     // time copying halo rows
+};
+
+// PartitionedExecutor runs layers part by part, each part on its own thread
+// over its local graph only. Between layers only the halo rows are refreshed
+// from their owning parts; nothing else is shared.
+//
+// Owned nodes keep their full neighbour list (in local ids, same order); halo
+// nodes get an empty list. Layers run through BaseLayer::forward_local_rows
+// with the partition's global degrees, so degree-based normalisation (GCN)
+// sees the true degree of halo nodes and the result is identical to the
+// unpartitioned forward pass.
+class PartitionedExecutor {
+public:
+    // part_of as returned by partition_graph
+    PartitionedExecutor(const vector<vector<int>>& adjacency_list, const vector<int>& part_of, int num_parts);
+
+    int num_parts() const { return static_cast<int>(parts.size()); }
+    const GraphPartition& partition(int part) const { return parts[part]; }
+
+    // Runs one layer on every part and returns the global output matrix
+    vector<vector<float>> forward(
+        BaseLayer& layer,
+        const vector<vector<float>>& node_features,
+        HaloExchangeStats* stats = nullptr
+    ) const;
+
+    // Runs every layer of a stack, exchanging halo rows between layers
+    vector<vector<float>> forward(
+        const LayerStack& stack,
+        const vector<vector<float>>& node_features,
+        HaloExchangeStats* stats = nullptr
+    ) const;
+
+private:
+    int num_nodes;
+    vector<GraphPartition> parts;
+    vector<vector<int>> owned_rows; // local ids 0..owned-1 per part (rows to compute)
+
+    // Runs layers [0, layers.size()) over the local matrices of every part
+    vector<vector<float>> run(
+        const vector<BaseLayer*>& layers,
+        const vector<vector<float>>& node_features,
+        HaloExchangeStats* stats
+    ) const;
+};
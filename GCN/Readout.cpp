@@ -0,0 +1,298 @@
+#include "Readout.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace OutputConverter {
+
+  namespace {
+
+    // values per block of the scalar reductions
+    const size_t kValueBlock = 4096;
+
+    // rows per block of the matrix readouts
+    const size_t kRowBlock = 1024;
+
+    // runs of up to this many rows are summed in order; longer ones are halved
+    const size_t kPairwiseBase = 16;
+
+    // enough scratch levels for any row block (log2(kRowBlock / kPairwiseBase) + 1)
+    const int kMaxPairwiseDepth = 16;
+
+    // inputs below this many values are reduced on the calling thread
+    const size_t kParallelThreshold = 1 << 16;
+
+    int threadsFor(size_t work, int requested) {
+      if (work < kParallelThreshold) return 1;
+      return requested > 0 ? requested : default_thread_count();
+    }
+
+    // Combines first[0 .. count) in a fixed binary tree; the result ends up in first[0]
+    template <typename T, typename Combine>
+    void pairwiseCombine(T* first, size_t count, Combine combine) {
+      for (size_t stride = 1; stride < count; stride *= 2) {
+        for (size_t k = 0; k + stride < count; k += 2 * stride) {
+          combine(first[k], first[k + stride]);
+        }
+      }
+    }
+
+    // Eight independent accumulators: lane k takes every eighth value, so the
+    // inner loop has no loop-carried dependency and maps onto SIMD registers.
+    float sumBlock(const float* v, size_t n) {
+      float lane[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      size_t i = 0;
+      for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k < 8; ++k) lane[k] += v[i + k];
+      }
+      for (int k = 0; i < n; ++i, ++k) lane[k] += v[i];
+      return ((lane[0] + lane[1]) + (lane[2] + lane[3]))
+           + ((lane[4] + lane[5]) + (lane[6] + lane[7]));
+    }
+
+    template <typename Pick>
+    float extremeBlock(const float* v, size_t n, Pick pick) {
+      float lane[8];
+      for (int k = 0; k < 8; ++k) lane[k] = v[0];
+      size_t i = 0;
+      for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k < 8; ++k) lane[k] = pick(lane[k], v[i + k]);
+      }
+      for (int k = 0; i < n; ++i, ++k) lane[k] = pick(lane[k], v[i]);
+      float result = lane[0];
+      for (int k = 1; k < 8; ++k) result = pick(result, lane[k]);
+      return result;
+    }
+
+    // Reduces fixed blocks in parallel, then combines the block results pairwise
+    template <typename BlockFn, typename Combine>
+    float reduceBlocks(const float* values, size_t count, int num_threads, BlockFn block, Combine combine) {
+      if (count == 0) return 0.0f;
+      size_t n_blocks = (count + kValueBlock - 1) / kValueBlock;
+      vector<float> partial(n_blocks);
+      parallel_for(0, n_blocks, threadsFor(count, num_threads), [&](long long first, long long last, int) {
+        for (long long b = first; b < last; ++b) {
+          size_t begin = b * kValueBlock;
+          partial[b] = block(values + begin, min(kValueBlock, count - begin));
+        }
+      });
+      pairwiseCombine(partial.data(), n_blocks, combine);
+      return partial[0];
+    }
+
+    // Rows [begin, end) of one graph, the unit of parallel work
+    struct RowBlock {
+      size_t graph;
+      size_t begin;
+      size_t end;
+    };
+
+    // Adds rows [begin, end) into out (width = dim, or dim + 1 when weighted:
+    // the last slot then collects the weight total). Halves the range
+    // recursively, so the error grows with log(rows); scratch[depth] holds the
+    // right half at each level.
+    void sumRows(
+      const vector<vector<float>>& features,
+      const float*                 weights,
+      size_t                       begin,
+      size_t                       end,
+      vector<float>&               out,
+      vector<vector<float>>&       scratch,
+      int                          depth
+    ) {
+      size_t dim = features[begin].size();
+      fill(out.begin(), out.end(), 0.0f);
+      if (end - begin <= kPairwiseBase) {
+        for (size_t i = begin; i < end; ++i) {
+          const float* x = features[i].data();
+          if (weights) {
+            float w = weights[i];
+            for (size_t d = 0; d < dim; ++d) out[d] += w * x[d];
+            out[dim] += w;
+          } else {
+            for (size_t d = 0; d < dim; ++d) out[d] += x[d];
+          }
+        }
+        return;
+      }
+      size_t mid = begin + (end - begin) / 2;
+      sumRows(features, weights, begin, mid, out, scratch, depth + 1);
+      vector<float>& right = scratch[depth];
+      right.resize(out.size());
+      sumRows(features, weights, mid, end, right, scratch, depth + 1);
+      for (size_t d = 0; d < out.size(); ++d) out[d] += right[d];
+    }
+
+    void addInto(vector<float>& target, const vector<float>& source) {
+      for (size_t d = 0; d < target.size(); ++d) target[d] += source[d];
+    }
+
+  }  // namespace
+
+  Pooling parsePooling(const string& name) {
+    if (name == "sum") return Pooling::Sum;
+    if (name == "mean") return Pooling::Mean;
+    if (name == "max") return Pooling::Max;
+    if (name == "min") return Pooling::Min;
+    if (name == "attention") return Pooling::Attention;
+    throw invalid_argument("unknown readout '" + name + "' (expected sum, mean, max, min or attention)");
+  }
+
+  float reduceSum(const float* values, size_t count, int num_threads) {
+    return reduceBlocks(values, count, num_threads, sumBlock,
+                        [](float& a, float b) { a += b; });
+  }
+
+  float reduceMax(const float* values, size_t count, int num_threads) {
+    auto pick = [](float a, float b) { return max(a, b); };
+    return reduceBlocks(values, count, num_threads,
+                        [&](const float* v, size_t n) { return extremeBlock(v, n, pick); },
+                        [&](float& a, float b) { a = pick(a, b); });
+  }
+
+  float reduceMin(const float* values, size_t count, int num_threads) {
+    auto pick = [](float a, float b) { return min(a, b); };
+    return reduceBlocks(values, count, num_threads,
+                        [&](const float* v, size_t n) { return extremeBlock(v, n, pick); },
+                        [&](float& a, float b) { a = pick(a, b); });
+  }
+
+  vector<float> rowSums(const vector<vector<float>>& features, int num_threads) {
+    vector<float> sums(features.size());
+    size_t dim = features.empty() ? 0 : features[0].size();
+    parallel_for(0, features.size(), threadsFor(features.size() * dim, num_threads),
+                 [&](long long first, long long last, int) {
+      for (long long i = first; i < last; ++i) {
+        sums[i] = reduceSum(features[i].data(), features[i].size(), 1);
+      }
+    });
+    return sums;
+  }
+
+  vector<float> readout(
+    const vector<vector<float>>& features,
+    Pooling                      pooling,
+    const ReadoutOptions&        options
+  ) {
+    return segmentedReadout(features, {0, features.size()}, pooling, options)[0];
+  }
+
+  vector<vector<float>> segmentedReadout(
+    const vector<vector<float>>& features,
+    const vector<size_t>&        offsets,
+    Pooling                      pooling,
+    const ReadoutOptions&        options
+  ) {
+    size_t n_rows = features.size();
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != n_rows ||
+        !is_sorted(offsets.begin(), offsets.end())) {
+      throw invalid_argument("readout offsets must run from 0 to the number of rows in ascending order");
+    }
+    size_t dim = features.empty() ? 0 : features[0].size();
+    for (const auto& row : features) {
+      if (row.size() != dim) throw invalid_argument("readout needs rows of equal dimension");
+    }
+    bool attention = pooling == Pooling::Attention;
+    if (attention && options.attention_gate.size() != dim) {
+      throw invalid_argument("attention readout needs a gate of size " + to_string(dim));
+    }
+
+    size_t n_graphs = offsets.size() - 1;
+    vector<RowBlock> blocks;
+    vector<size_t> graph_block_begin(n_graphs + 1);
+    for (size_t g = 0; g < n_graphs; ++g) {
+      graph_block_begin[g] = blocks.size();
+      for (size_t b = offsets[g]; b < offsets[g + 1]; b += kRowBlock) {
+        blocks.push_back({g, b, min(offsets[g + 1], b + kRowBlock)});
+      }
+    }
+    graph_block_begin[n_graphs] = blocks.size();
+    int threads = threadsFor(n_rows * dim, options.num_threads);
+
+    // attention weights exp(score - max score of the graph), score = gate · h_i
+    vector<float> weights;
+    if (attention) {
+      weights.resize(n_rows);
+      parallel_for(0, n_rows, threads, [&](long long first, long long last, int) {
+        for (long long i = first; i < last; ++i) {
+          float score = 0.0f;
+          for (size_t d = 0; d < dim; ++d) score += options.attention_gate[d] * features[i][d];
+          weights[i] = score;
+        }
+      });
+      vector<float> graph_max(n_graphs);
+      for (size_t g = 0; g < n_graphs; ++g) {
+        graph_max[g] = reduceMax(weights.data() + offsets[g], offsets[g + 1] - offsets[g], threads);
+      }
+      parallel_for(0, blocks.size(), threads, [&](long long first, long long last, int) {
+        for (long long b = first; b < last; ++b) {
+          for (size_t i = blocks[b].begin; i < blocks[b].end; ++i) {
+            weights[i] = exp(weights[i] - graph_max[blocks[b].graph]);
+          }
+        }
+      });
+    }
+
+    // one partial result per row block
+    size_t width = dim + (attention ? 1 : 0);
+    vector<vector<float>> partial(blocks.size());
+    parallel_for(0, blocks.size(), threads, [&](long long first, long long last, int) {
+      vector<vector<float>> scratch(kMaxPairwiseDepth);
+      for (long long b = first; b < last; ++b) {
+        const RowBlock& block = blocks[b];
+        vector<float>& out = partial[b];
+        out.resize(width);
+        if (pooling == Pooling::Max || pooling == Pooling::Min) {
+          out = features[block.begin];
+          for (size_t i = block.begin + 1; i < block.end; ++i) {
+            const float* x = features[i].data();
+            for (size_t d = 0; d < dim; ++d) {
+              out[d] = pooling == Pooling::Max ? max(out[d], x[d]) : min(out[d], x[d]);
+            }
+          }
+        } else {
+          sumRows(features, attention ? weights.data() : nullptr, block.begin, block.end, out, scratch, 0);
+        }
+      }
+    });
+
+    // combine the blocks of every graph in a fixed pairwise order
+    vector<vector<float>> pooled(n_graphs, vector<float>(dim, 0.0f));
+    parallel_for(0, n_graphs, threadsFor(blocks.size() * width, options.num_threads),
+                 [&](long long first, long long last, int) {
+      for (long long g = first; g < last; ++g) {
+        size_t begin = graph_block_begin[g];
+        size_t count = graph_block_begin[g + 1] - begin;
+        if (count == 0) continue;
+        vector<float>* parts = partial.data() + begin;
+        switch (pooling) {
+          case Pooling::Max:
+            pairwiseCombine(parts, count, [](vector<float>& a, const vector<float>& b) {
+              for (size_t d = 0; d < a.size(); ++d) a[d] = max(a[d], b[d]);
+            });
+            pooled[g] = parts[0];
+            break;
+          case Pooling::Min:
+            pairwiseCombine(parts, count, [](vector<float>& a, const vector<float>& b) {
+              for (size_t d = 0; d < a.size(); ++d) a[d] = min(a[d], b[d]);
+            });
+            pooled[g] = parts[0];
+            break;
+          case Pooling::Sum:
+          case Pooling::Mean:
+          case Pooling::Attention: {
+            pairwiseCombine(parts, count, addInto);
+            float divisor = pooling == Pooling::Sum ? 1.0f
+                          : pooling == Pooling::Mean ? static_cast<float>(offsets[g + 1] - offsets[g])
+                          : parts[0][dim];
+            for (size_t d = 0; d < dim; ++d) pooled[g][d] = parts[0][d] / divisor;
+            break;
+          }
+        }
+      }
+    });
+    return pooled;
+  }
+
+} // namespace OutputConverter
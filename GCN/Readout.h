@@ -0,0 +1,67 @@
+// Readout.h
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace OutputConverter {
+
+  //──────────────────────────────────────────────────────────────────────────
+  // Graph readouts: pool a [n_nodes][dim] embedding matrix into one [dim]
+  // vector per graph, without scalarizing the nodes first.
+  //
+  // Every reduction works on fixed-size blocks of rows (or values) that do not
+  // depend on the thread count; block results are combined in a fixed
+  // pairwise tree. The result is therefore bit-identical for any number of
+  // threads. Rounding error grows with log(n) instead of n, which keeps fp32
+  // totals usable on graphs with 100M nodes.
+  //──────────────────────────────────────────────────────────────────────────
+
+  enum class Pooling {
+    Sum,
+    Mean,
+    Max,
+    Min,
+    Attention  // softmax(gate · h_i) weighted sum of the rows
+  };
+
+  // Parses "sum", "mean", "max", "min" or "attention"; throws invalid_argument otherwise
+  Pooling parsePooling(const string& name);
+
+  struct ReadoutOptions {
+    int num_threads = 0;           // workers for large inputs; 0 = default_thread_count()
+    vector<float> attention_gate;  // [dim] gate vector, required for Pooling::Attention
+  };
+
+  // Sum / max / min of 'count' floats. Each block is reduced with eight
+  // independent lane accumulators (vectorizable), blocks are combined pairwise.
+  // Max and min of an empty range are 0, like DefaultAgg::maxGraph/minGraph.
+  float reduceSum(const float* values, size_t count, int num_threads = 0);
+  float reduceMax(const float* values, size_t count, int num_threads = 0);
+  float reduceMin(const float* values, size_t count, int num_threads = 0);
+
+  // Per-node sum of the embedding (the scalar node score used by toEdgeScores)
+  vector<float> rowSums(const vector<vector<float>>& features, int num_threads = 0);
+
+  // Pools all rows into one [dim] vector; an empty matrix gives an empty vector.
+  // Throws invalid_argument for ragged rows or a gate of the wrong size.
+  vector<float> readout(
+    const vector<vector<float>>& features,
+    Pooling                      pooling,
+    const ReadoutOptions&        options = {}
+  );
+
+  // Pools a batch of graphs stored back to back: graph g owns rows
+  // [offsets[g], offsets[g + 1]). 'offsets' must start at 0, be non-decreasing
+  // and end at features.size(). Empty graphs pool to zeros.
+  vector<vector<float>> segmentedReadout(
+    const vector<vector<float>>& features,
+    const vector<size_t>&        offsets,
+    Pooling                      pooling,
+    const ReadoutOptions&        options = {}
+  );
+
+} // namespace OutputConverter
@@ -0,0 +1,373 @@
+// Shard.cpp
+
+#include "Shard.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using Clock = chrono::steady_clock;
+
+namespace {
+
+const size_t kAlignment = 64;
+
+size_t align_up(size_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+double seconds_since(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Anonymous shared mapping that survives fork(); unmapped by its creator
+class SharedRegion {
+public:
+    explicit SharedRegion(size_t bytes) : bytes(max<size_t>(bytes, 1)) {
+        address = mmap(nullptr, this->bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            throw runtime_error("cannot map " + to_string(this->bytes) + " bytes of shared memory");
+        }
+    }
+    ~SharedRegion() { munmap(address, bytes); }
+
+    SharedRegion(const SharedRegion&) = delete;
+    SharedRegion& operator=(const SharedRegion&) = delete;
+
+    char* get() const { return static_cast<char*>(address); }
+
+private:
+    size_t bytes;
+    void* address;
+};
+
+// What one worker reports about one layer
+struct WorkerLayerRecord {
+    double compute_seconds;
+    double exchange_seconds;
+    long long rows_sent;
+    long long rows_received;
+};
+
+}  // namespace
+
+SharedMemoryTransport::SharedMemoryTransport(const vector<int>& export_counts, int max_dim)
+    : max_dim(max_dim), export_counts(export_counts) {
+    size_t floats = 0;
+    for (int count : export_counts) {
+        buffer_offset.push_back(floats);
+        floats += 2 * static_cast<size_t>(count) * max_dim;
+    }
+
+    size_t header = align_up(sizeof(pthread_barrier_t));
+    mapping_bytes = header + max<size_t>(floats, 1) * sizeof(float);
+    mapping = mmap(nullptr, mapping_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw runtime_error("SharedMemoryTransport: cannot map " + to_string(mapping_bytes) + " bytes");
+    }
+    data = reinterpret_cast<float*>(static_cast<char*>(mapping) + header);
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    int rc = pthread_barrier_init(barrier(), &attr, max<unsigned>(export_counts.size(), 1));
+    pthread_barrierattr_destroy(&attr);
+    if (rc != 0) {
+        munmap(mapping, mapping_bytes);
+        throw runtime_error("SharedMemoryTransport: cannot create process-shared barrier");
+    }
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    pthread_barrier_destroy(barrier());
+    munmap(mapping, mapping_bytes);
+}
+
+pthread_barrier_t* SharedMemoryTransport::barrier() const {
+    return static_cast<pthread_barrier_t*>(mapping);
+}
+
+void SharedMemoryTransport::publish(int shard, int step, const float* rows, int dim) {
+    if (dim > max_dim) {
+        throw invalid_argument("SharedMemoryTransport: row dimension exceeds the buffer size");
+    }
+    size_t count = export_counts[shard];
+    float* target = data + buffer_offset[shard] + (step % 2) * count * max_dim;
+    memcpy(target, rows, count * dim * sizeof(float));
+    pthread_barrier_wait(barrier());
+}
+
+const float* SharedMemoryTransport::exports(int owner, int step) const {
+    size_t count = export_counts[owner];
+    return data + buffer_offset[owner] + (step % 2) * count * max_dim;
+}
+
+ShardedExecutor::ShardedExecutor(vector<int> part_of_in, int num_shards, const vector<vector<int>>& halos)
+    : num_nodes(part_of_in.size()),
+      part_of(std::move(part_of_in)),
+      exported(num_shards),
+      halo_source(num_shards) {
+    if (static_cast<int>(halos.size()) != num_shards) {
+        throw invalid_argument("ShardedExecutor: one halo list per shard expected");
+    }
+    // local id of every node in its own shard (owned nodes keep their global order)
+    vector<int> local_index(num_nodes);
+    vector<int> owned_count(num_shards, 0);
+    for (int v = 0; v < num_nodes; v++) {
+        if (part_of[v] < 0 || part_of[v] >= num_shards) {
+            throw invalid_argument("ShardedExecutor: part id out of range");
+        }
+        local_index[v] = owned_count[part_of[v]]++;
+    }
+
+    // export position of every owned row that is someone's halo (-1 otherwise)
+    vector<vector<int>> position(num_shards);
+    for (int s = 0; s < num_shards; s++) {
+        position[s].assign(owned_count[s], -1);
+    }
+    for (int s = 0; s < num_shards; s++) {
+        for (int v : halos[s]) {
+            int owner = part_of[v];
+            int local_id = local_index[v];
+            if (position[owner][local_id] < 0) {
+                position[owner][local_id] = exported[owner].size();
+                exported[owner].push_back(local_id);
+            }
+            halo_source[s].push_back(position[owner][local_id]);
+        }
+    }
+}
+
+ShardedExecutor::ShardedExecutor(
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& part_of,
+    int num_shards
+) : ShardedExecutor(part_of, num_shards, partition_halos(adjacency_list, part_of, num_shards)) {}
+
+vector<int> ShardedExecutor::export_counts() const {
+    vector<int> counts;
+    for (const vector<int>& rows : exported) {
+        counts.push_back(rows.size());
+    }
+    return counts;
+}
+
+vector<vector<float>> ShardedExecutor::forward(
+    const LayerStack& stack,
+    const vector<vector<int>>& adjacency_list,
+    const vector<vector<float>>& node_features,
+    vector<ShardLayerStats>* stats
+) const {
+    if (stack.size() == 0) return node_features;
+    ShardLoader load_shard = [&](int s, vector<vector<float>>& local_features) {
+        GraphPartition p = build_partition(adjacency_list, part_of, num_shards(), s);
+        local_features = gather_rows(p, node_features);
+        return p;
+    };
+    return run(stack, load_shard, nullptr, stats);
+}
+
+vector<vector<float>> ShardedExecutor::forward(
+    const LayerStack& stack,
+    const string& graph_file,
+    vector<ShardLayerStats>* stats
+) const {
+    ShardLoader load_shard = [&](int s, vector<vector<float>>& local_features) {
+        return load_partition(graph_file, part_of, num_shards(), s, local_features);
+    };
+    return run(stack, load_shard, nullptr, stats);
+}
+
+vector<vector<float>> ShardedExecutor::forward(
+    const LayerStack& stack,
+    const vector<vector<int>>& adjacency_list,
+    const vector<vector<float>>& node_features,
+    ShardTransport& transport,
+    vector<ShardLayerStats>* stats
+) const {
+    if (stack.size() == 0) return node_features;
+    ShardLoader load_shard = [&](int s, vector<vector<float>>& local_features) {
+        GraphPartition p = build_partition(adjacency_list, part_of, num_shards(), s);
+        local_features = gather_rows(p, node_features);
+        return p;
+    };
+    return run(stack, load_shard, &transport, stats);
+}
+
+vector<vector<float>> ShardedExecutor::forward(
+    const LayerStack& stack,
+    const string& graph_file,
+    ShardTransport& transport,
+    vector<ShardLayerStats>* stats
+) const {
+    ShardLoader load_shard = [&](int s, vector<vector<float>>& local_features) {
+        return load_partition(graph_file, part_of, num_shards(), s, local_features);
+    };
+    return run(stack, load_shard, &transport, stats);
+}
+
+vector<vector<float>> ShardedExecutor::run(
+    const LayerStack& stack,
+    const ShardLoader& load_shard,
+    ShardTransport* transport,
+    vector<ShardLayerStats>* stats
+) const {
+    if (stats) stats->clear();
+    int n_shards = num_shards();
+    int n_layers = stack.size();
+    if (n_layers == 0) {
+        throw invalid_argument("ShardedExecutor: empty layer stack");
+    }
+    int out_dim = stack.get_output_dim();
+
+    // without a caller-provided transport, one sized for the widest layer
+    unique_ptr<SharedMemoryTransport> own_transport;
+    if (!transport) {
+        int max_dim = 1;
+        for (int l = 0; l < n_layers; l++) {
+            max_dim = max(max_dim, stack.layer(l).get_output_dim());
+        }
+        own_transport.reset(new SharedMemoryTransport(export_counts(), max_dim));
+        transport = own_transport.get();
+    }
+
+    // results and per-layer records come back through shared memory
+    size_t records_bytes = align_up(sizeof(WorkerLayerRecord) * n_shards * n_layers);
+    SharedRegion region(records_bytes + sizeof(float) * static_cast<size_t>(num_nodes) * out_dim);
+    WorkerLayerRecord* records = reinterpret_cast<WorkerLayerRecord*>(region.get());
+    float* output_rows = reinterpret_cast<float*>(region.get() + records_bytes);
+
+    auto run_worker = [&](int s) {
+        vector<vector<float>> local;
+        GraphPartition p = load_shard(s, local);
+        if (p.halo.size() != halo_source[s].size()) {
+            throw runtime_error("ShardedExecutor: shard " + to_string(s) + " does not match the halo tables");
+        }
+
+        vector<int> rows(p.num_owned());
+        for (int k = 0; k < p.num_owned(); k++) rows[k] = k;
+
+        vector<vector<float>> next;
+        vector<float> packed;
+        for (int l = 0; l < n_layers; l++) {
+            WorkerLayerRecord& record = records[s * n_layers + l];
+            BaseLayer& layer = stack.layer(l);
+
+            Clock::time_point start = Clock::now();
+            next.assign(p.num_local(), vector<float>());
+            layer.forward_local_rows(local, p.local_adjacency, p.degree, rows, next);
+            record.compute_seconds = seconds_since(start);
+
+            // the last layer's halo rows are never read
+            if (l + 1 < n_layers) {
+                start = Clock::now();
+                int dim = layer.get_output_dim();
+                packed.resize(exported[s].size() * dim);
+                for (size_t k = 0; k < exported[s].size(); k++) {
+                    copy(next[exported[s][k]].begin(), next[exported[s][k]].end(), packed.begin() + k * dim);
+                }
+                transport->publish(s, l, packed.data(), dim);
+
+                for (size_t h = 0; h < p.halo.size(); h++) {
+                    const float* source = transport->exports(p.halo_owner[h], l) + static_cast<size_t>(halo_source[s][h]) * dim;
+                    next[p.num_owned() + h].assign(source, source + dim);
+                }
+                record.exchange_seconds = seconds_since(start);
+                record.rows_sent = exported[s].size();
+                record.rows_received = p.halo.size();
+            }
+            swap(local, next);
+        }
+
+        for (int k = 0; k < p.num_owned(); k++) {
+            copy(local[k].begin(), local[k].end(), output_rows + static_cast<size_t>(p.owned[k]) * out_dim);
+        }
+    };
+
+    // one worker process per shard
+    vector<pid_t> workers;
+    for (int s = 0; s < n_shards; s++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int code = 0;
+            try {
+                run_worker(s);
+            } catch (const exception& e) {
+                fprintf(stderr, "shard %d: %s\n", s, e.what());
+                code = 1;
+            } catch (...) {
+                fprintf(stderr, "shard %d: unknown error\n", s);
+                code = 1;
+            }
+            _exit(code);
+        }
+        if (pid < 0) {
+            for (pid_t worker : workers) kill(worker, SIGKILL);
+            for (pid_t worker : workers) waitpid(worker, nullptr, 0);
+            throw runtime_error("ShardedExecutor: fork failed");
+        }
+        workers.push_back(pid);
+    }
+
+    // a failed worker would leave the others waiting at the barrier: stop them.
+    // Only our own workers are reaped (other children of the caller are left
+    // alone), so poll them instead of blocking on one that may wait forever.
+    bool failed = false;
+    vector<pid_t> running = workers;
+    while (!running.empty()) {
+        bool reaped = false;
+        for (size_t w = 0; w < running.size();) {
+            int status = 0;
+            pid_t pid = waitpid(running[w], &status, WNOHANG);
+            if (pid == 0 || (pid < 0 && errno == EINTR)) {
+                w++;
+                continue;
+            }
+            if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                if (!failed) {
+                    for (pid_t worker : running) {
+                        if (worker != running[w]) kill(worker, SIGKILL);
+                    }
+                }
+                failed = true;
+            }
+            running.erase(running.begin() + w);
+            reaped = true;
+        }
+        if (!reaped) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    if (failed) {
+        throw runtime_error("ShardedExecutor: a worker process failed");
+    }
+
+    vector<vector<float>> output(num_nodes);
+    for (int v = 0; v < num_nodes; v++) {
+        const float* row = output_rows + static_cast<size_t>(v) * out_dim;
+        output[v].assign(row, row + out_dim);
+    }
+
+    if (stats) {
+        stats->resize(n_layers);
+        for (int l = 0; l < n_layers; l++) {
+            ShardLayerStats& layer_stats = (*stats)[l];
+            int dim = stack.layer(l).get_output_dim();
+            for (int s = 0; s < n_shards; s++) {
+                const WorkerLayerRecord& record = records[s * n_layers + l];
+                layer_stats.rows_sent += record.rows_sent;
+                layer_stats.rows_received += record.rows_received;
+                layer_stats.compute_seconds = max(layer_stats.compute_seconds, record.compute_seconds);
+                layer_stats.exchange_seconds = max(layer_stats.exchange_seconds, record.exchange_seconds);
+            }
+            layer_stats.bytes_sent = layer_stats.rows_sent * dim * static_cast<long long>(sizeof(float));
+        }
+    }
+    return output;
+}
@@ -0,0 +1,143 @@
+// Shard.h
+
+#pragma once
+#include "LayerStack.h"
+#include "Partition.h"
+#include <functional>
+#include <pthread.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+// ShardTransport moves boundary activations between shards after each layer.
+// Every shard owns an export list: the owned rows some other shard holds as
+// halo. After a layer each shard publishes its export rows; once all shards
+// have published, every shard reads the rows it needs from the others.
+// Implementations must work across processes created with fork() after the
+// transport was constructed.
+class ShardTransport {
+public:
+    virtual ~ShardTransport() {}
+
+    virtual string name() const = 0;
+
+    // Publishes 'rows' (export_count(shard) rows of 'dim' floats, row-major)
+    // as the shard's exports for exchange 'step', then blocks until every
+    // shard has published that step
+    virtual void publish(int shard, int step, const float* rows, int dim) = 0;
+
+    // Export rows of 'owner' for 'step', readable after publish() returned.
+    // They stay valid until the shards publish step + 2.
+    virtual const float* exports(int owner, int step) const = 0;
+};
+
+// Transport over one anonymous shared mapping created before the workers are
+// forked: two export buffers per shard (alternating steps, so a shard can
+// publish the next step while others still read the previous one) and a
+// process-shared pthread barrier.
+class SharedMemoryTransport : public ShardTransport {
+public:
+    // export_counts[s] rows of up to max_dim floats per shard;
+    // throws runtime_error if the mapping cannot be created
+    SharedMemoryTransport(const vector<int>& export_counts, int max_dim);
+    ~SharedMemoryTransport() override;
+
+    SharedMemoryTransport(const SharedMemoryTransport&) = delete;
+    SharedMemoryTransport& operator=(const SharedMemoryTransport&) = delete;
+
+    string name() const override { return "shared-memory"; }
+    void publish(int shard, int step, const float* rows, int dim) override;
+    const float* exports(int owner, int step) const override;
+
+private:
+    int max_dim;
+    vector<int> export_counts;
+    vector<size_t> buffer_offset; // float offset of each shard's first buffer
+    void* mapping = nullptr;
+    size_t mapping_bytes = 0;
+    float* data = nullptr;        // export buffers, after the barrier
+
+    pthread_barrier_t* barrier() const;
+};
+
+// Communication and compute of one layer, over all shards
+struct ShardLayerStats {
+    long long rows_sent = 0;        // boundary rows published after the layer
+    long long bytes_sent = 0;       // the same in bytes
+    long long rows_received = 0;    // halo rows read by all shards
+    double compute_seconds = 0.0;   // slowest shard's time in the layer
+    double exchange_seconds = 0.0;  // slowest shard's publish + wait + copy time
+};
+
+// ShardedExecutor runs a layer stack with one worker process per shard.
+// The driver keeps only coordination state: the part of every node and, per
+// shard, which owned rows it exports and where each of its halo rows comes
+// from. After fork each worker builds (from an in-memory graph) or streams
+// (from the graph file) only its own shard, numbered as build_partition does,
+// computes its own rows over that local graph and exchanges boundary rows
+// through the transport after every layer; the driver collects the owned
+// rows from a shared output mapping. The result is identical to
+// LayerStack::forward.
+class ShardedExecutor {
+public:
+    // part_of as returned by partition_graph, halos as returned by partition_halos
+    ShardedExecutor(vector<int> part_of, int num_shards, const vector<vector<int>>& halos);
+
+    // Same, deriving the halos from the graph (which is not kept)
+    ShardedExecutor(const vector<vector<int>>& adjacency_list, const vector<int>& part_of, int num_shards);
+
+    int num_shards() const { return static_cast<int>(exported.size()); }
+
+    // rows each shard publishes after a layer
+    vector<int> export_counts() const;
+
+    // In-memory graph: each worker builds its shard with build_partition.
+    // Runs across forked workers over a SharedMemoryTransport; 'stats'
+    // receives one entry per layer. Throws runtime_error if a worker fails.
+    vector<vector<float>> forward(
+        const LayerStack& stack,
+        const vector<vector<int>>& adjacency_list,
+        const vector<vector<float>>& node_features,
+        vector<ShardLayerStats>* stats = nullptr
+    ) const;
+
+    // Graph file: each worker streams its shard with load_partition, so no
+    // process holds the whole graph (the driver only holds the output matrix)
+    vector<vector<float>> forward(
+        const LayerStack& stack,
+        const string& graph_file,
+        vector<ShardLayerStats>* stats = nullptr
+    ) const;
+
+    // Same over a caller-provided transport, which must have been sized with
+    // export_counts() and the largest layer output dimension
+    vector<vector<float>> forward(
+        const LayerStack& stack,
+        const vector<vector<int>>& adjacency_list,
+        const vector<vector<float>>& node_features,
+        ShardTransport& transport,
+        vector<ShardLayerStats>* stats = nullptr
+    ) const;
+    vector<vector<float>> forward(
+        const LayerStack& stack,
+        const string& graph_file,
+        ShardTransport& transport,
+        vector<ShardLayerStats>* stats = nullptr
+    ) const;
+
+private:
+    // Produces shard s in a worker: its local graph and the input rows of its local nodes
+    using ShardLoader = function<GraphPartition(int s, vector<vector<float>>& local_features)>;
+
+    int num_nodes;
+    vector<int> part_of;
+    vector<vector<int>> exported;     // local ids of each shard's export rows
+    vector<vector<int>> halo_source;  // position of each halo row in its owner's exports
+
+    vector<vector<float>> run(
+        const LayerStack& stack,
+        const ShardLoader& load_shard,
+        ShardTransport* transport,
+        vector<ShardLayerStats>* stats
+    ) const;
+};
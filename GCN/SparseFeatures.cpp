@@ -0,0 +1,48 @@
+// SparseFeatures.cpp
+
+#include "SparseFeatures.h"
+
+SparseFeatures SparseFeatures::from_dense(const vector<vector<float>>& features) {
+    SparseFeatures sparse;
+    sparse.num_rows = features.size();
+    sparse.num_cols = features.empty() ? 0 : features[0].size();
+    sparse.row_offsets.resize(sparse.num_rows + 1);
+
+    for (int i = 0; i < sparse.num_rows; i++) {
+        sparse.row_offsets[i] = sparse.values.size();
+        for (int d = 0; d < sparse.num_cols; d++) {
+            if (features[i][d] != 0.0f) {
+                sparse.col_indices.push_back(d);
+                sparse.values.push_back(features[i][d]);
+            }
+        }
+    }
+    sparse.row_offsets[sparse.num_rows] = sparse.values.size();
+    return sparse;
+}
+
+vector<vector<float>> SparseFeatures::to_dense() const {
+    vector<vector<float>> features(num_rows, vector<float>(num_cols, 0.0f));
+    for (int i = 0; i < num_rows; i++) {
+        for (int k = row_offsets[i]; k < row_offsets[i + 1]; k++) {
+            features[i][col_indices[k]] = values[k];
+        }
+    }
+    return features;
+}
+
+float SparseFeatures::density() const {
+    if (num_rows == 0 || num_cols == 0) return 0.0f;
+    return static_cast<float>(values.size()) / (static_cast<float>(num_rows) * num_cols);
+}
+
+float feature_density(const vector<vector<float>>& features) {
+    size_t nonzeros = 0, total = 0;
+    for (const auto& row : features) {
+        for (float val : row) {
+            if (val != 0.0f) nonzeros++;
+        }
+        total += row.size();
+    }
+    return total == 0 ? 0.0f : static_cast<float>(nonzeros) / total;
+}
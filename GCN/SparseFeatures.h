@@ -0,0 +1,33 @@
+// SparseFeatures.h
+
+#pragma once
+#include <vector>
+using namespace std;
+
+// SparseFeatures holds a node-feature matrix in compressed sparse row form.
+// After a ReLU most activations are exactly zero, so the next layer can walk
+// only the stored non-zeros of each row instead of the full dense row.
+class SparseFeatures {
+public:
+    int num_rows = 0;          // number of nodes
+    int num_cols = 0;          // feature dimension
+
+    vector<int> row_offsets;   // start of each row's non-zeros : [num_rows + 1]
+    vector<int> col_indices;   // feature index of each non-zero (ascending within a row)
+    vector<float> values;      // value of each non-zero
+
+    // Builds the sparse form of a dense feature matrix, dropping exact zeros
+    static SparseFeatures from_dense(const vector<vector<float>>& features);
+
+    // Expands back into a dense [num_rows][num_cols] matrix
+    vector<vector<float>> to_dense() const;
+
+    // number of stored non-zeros in a row
+    int row_nnz(int row) const { return row_offsets[row + 1] - row_offsets[row]; }
+
+    // fraction of entries that are non-zero
+    float density() const;
+};
+
+// Fraction of non-zero entries of a dense feature matrix
+float feature_density(const vector<vector<float>>& features);
@@ -0,0 +1,43 @@
+// Trainer.cpp
+
+#include "Trainer.h"
+#include "Loss.h"
+
+Trainer::Trainer(LayerStack& stack, Optimizer& optimizer) : stack(stack), optimizer(optimizer) {}
+
+float Trainer::step(
+    const vector<vector<float>>& node_features,
+    const vector<vector<int>>& adjacency_list,
+    const vector<int>& labels
+) {
+    size_t n_layers = stack.size();
+    if (n_layers == 0) return 0.0f;
+
+    // forward, keeping each layer's output for its backward pass
+    vector<vector<vector<float>>> outputs(n_layers);
+    for (size_t l = 0; l < n_layers; l++) {
+        const vector<vector<float>>& input = l == 0 ? node_features : outputs[l - 1];
+        outputs[l] = stack.layer(l).forward_train(input, adjacency_list, !checkpointing);
+    }
+
+    vector<vector<float>> grad;
+    float loss = softmax_cross_entropy(outputs.back(), labels, &grad);
+
+    // backward, releasing each output once the layer above no longer needs it
+    vector<vector<float>*> params, grads;
+    for (size_t l = n_layers; l-- > 0;) {
+        BaseLayer& layer = stack.layer(l);
+        layer.zero_gradients();
+        const vector<vector<float>>& input = l == 0 ? node_features : outputs[l - 1];
+        grad = layer.backward(input, adjacency_list, outputs[l], grad);
+        vector<vector<float>>().swap(outputs[l]);
+
+        vector<vector<float>*> layer_params = layer.parameters();
+        vector<vector<float>*> layer_grads = layer.gradients();
+        params.insert(params.end(), layer_params.begin(), layer_params.end());
+        grads.insert(grads.end(), layer_grads.begin(), layer_grads.end());
+    }
+
+    optimizer.step(params, grads);
+    return loss;
+}
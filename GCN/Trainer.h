@@ -0,0 +1,37 @@
+// Trainer.h
+
+#pragma once
+#include "LayerStack.h"
+#include "Optimizer.h"
+#include <vector>
+using namespace std;
+
+// Trainer runs full-graph training steps on a layer stack:
+// forward through every layer, softmax cross-entropy on the final node scores,
+// backward through every layer and one optimizer update.
+//
+// Memory: the output of every layer is kept until its backward pass. With
+// activation checkpointing (the default) the intermediate aggregates of each
+// layer are not kept but recomputed during backward, which removes one
+// [number of nodes][dim] buffer per layer at the cost of one extra aggregation.
+class Trainer {
+public:
+    // the stack and the optimizer must outlive the trainer
+    Trainer(LayerStack& stack, Optimizer& optimizer);
+
+    // true (default): recompute aggregates in backward; false: store them
+    void set_activation_checkpointing(bool enabled) { checkpointing = enabled; }
+
+    // One training step; labels[i] is the class of node i or kIgnoreLabel.
+    // Returns the loss before the update.
+    float step(
+        const vector<vector<float>>& node_features, // input feature matrix
+        const vector<vector<int>>& adjacency_list,  // represents the graph
+        const vector<int>& labels                   // class per node, kIgnoreLabel to skip
+    );
+
+private:
+    LayerStack& stack;
+    Optimizer& optimizer;
+    bool checkpointing = true;
+};
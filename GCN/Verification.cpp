@@ -0,0 +1,322 @@
+// Verification.cpp
+
+#include "Verification.h"
+#include "CompressedAdjacency.h"
+#include "GraphBuilder.h"
+#include "GraphReader.h"
+#include "LayerStack.h"
+#include "OutputWriter.h"
+#include "Parallel.h"
+#include "SparseFeatures.h"
+#include "WeightInit.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+// shortest duration of one timed run
+const double kMinTimedSeconds = 0.02;
+
+// nodes per random stream of synthetic_graph (fixed, so the graph does not depend on the thread count)
+const int kSyntheticBlockNodes = 4096;
+
+// Execution paths every case is compared on
+enum class ExecPath { Dense, Split, Compressed, Sparse };
+
+const ExecPath kPaths[] = {ExecPath::Dense, ExecPath::Split, ExecPath::Compressed, ExecPath::Sparse};
+
+const char* path_name(ExecPath path) {
+    switch (path) {
+        case ExecPath::Dense: return "dense";
+        case ExecPath::Split: return "split";
+        case ExecPath::Compressed: return "compressed";
+        case ExecPath::Sparse: return "sparse";
+    }
+    return "";
+}
+
+// small enough that the hubs of the synthetic graphs are split into several segments
+HubSplitOptions verify_split_options() {
+    HubSplitOptions options;
+    options.degree_threshold = 64;
+    return options;
+}
+
+// Runs the stack layer by layer through one execution path
+vector<vector<float>> run_path(const LayerStack& stack, const Graph& g, ExecPath path) {
+    if (path == ExecPath::Dense) {
+        return stack.forward(g.node_features, g.adjacency_list);
+    }
+
+    CompressedAdjacency compressed;
+    if (path == ExecPath::Compressed) compressed = CompressedAdjacency(g.adjacency_list);
+
+    vector<vector<float>> x = g.node_features;
+    for (size_t l = 0; l < stack.size(); l++) {
+        BaseLayer& layer = stack.layer(l);
+        switch (path) {
+            case ExecPath::Split:
+                x = layer.forward_split(x, g.adjacency_list, verify_split_options());
+                break;
+            case ExecPath::Compressed:
+                x = layer.forward(x, compressed);
+                break;
+            case ExecPath::Sparse:
+                x = layer.forward(SparseFeatures::from_dense(x), g.adjacency_list);
+                break;
+            case ExecPath::Dense:
+                break;
+        }
+    }
+    return x;
+}
+
+// Largest |out - golden|; sets 'within' to false if any entry exceeds the tolerance
+float compare_outputs(
+    const vector<vector<float>>& out,
+    const vector<vector<float>>& golden,
+    const VerifyOptions& options,
+    bool& within
+) {
+    float max_error = 0.0f;
+    for (size_t i = 0; i < out.size(); i++) {
+        for (size_t d = 0; d < out[i].size(); d++) {
+            float error = fabs(out[i][d] - golden[i][d]);
+            if (!(error <= options.abs_tolerance + options.rel_tolerance * fabs(golden[i][d]))) {
+                within = false; // also catches NaN
+            }
+            max_error = max(max_error, error);
+        }
+    }
+    return max_error;
+}
+
+bool same_shape(const vector<vector<float>>& a, const vector<vector<float>>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].size() != b[i].size()) return false;
+    }
+    return true;
+}
+
+map<string, double> read_baselines(const string& path) {
+    map<string, double> baselines;
+    ifstream in(path);
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream iss(line);
+        string name;
+        double edges_per_second;
+        if (iss >> name >> edges_per_second) baselines[name] = edges_per_second;
+    }
+    return baselines;
+}
+
+void write_baselines(const string& path, const map<string, double>& baselines) {
+    ofstream out(path);
+    if (!out) throw runtime_error("cannot open " + path + " for writing");
+    out << "# <case> <edges per second>, dense path, fastest of the timed runs\n";
+    out << "# regenerate on a new machine with: graph_app --verify <golden_dir> --update-baselines\n";
+    for (const auto& [name, edges_per_second] : baselines) {
+        out << name << " " << static_cast<long long>(edges_per_second) << "\n";
+    }
+    if (!out) throw runtime_error("write to " + path + " failed");
+}
+
+// Checks (or in update mode, records) one case
+VerifyResult run_case(const VerifyCase& c, const VerifyOptions& options, map<string, double>& baselines) {
+    VerifyResult result;
+    result.name = c.name;
+
+    Graph g = load_verify_graph(c.graph, options.golden_dir);
+    LayerStack stack = LayerStack::from_spec(c.model_spec, g.num_node_features, c.seed);
+    string golden_path = (fs::path(options.golden_dir) / (c.name + ".npy")).string();
+
+    // correctness: every execution path against the golden tensor
+    vector<vector<float>> golden;
+    if (options.update_golden) {
+        golden = run_path(stack, g, ExecPath::Dense);
+        OutputWriter::write_embeddings(golden_path, golden, OutputWriter::Format::Npy);
+    } else if (!fs::exists(golden_path)) {
+        result.error = "missing golden tensor " + golden_path;
+        return result;
+    } else {
+        golden = OutputWriter::read_embeddings(golden_path);
+    }
+
+    for (ExecPath path : kPaths) {
+        vector<vector<float>> out = run_path(stack, g, path);
+        if (!same_shape(out, golden)) {
+            result.outputs_ok = false;
+            result.worst_path = path_name(path);
+            result.error = string("output shape of the ") + path_name(path) + " path differs from the golden tensor";
+            return result;
+        }
+        float error = compare_outputs(out, golden, options, result.outputs_ok);
+        if (result.worst_path.empty() || error > result.max_abs_error) {
+            result.max_abs_error = error;
+            result.worst_path = path_name(path);
+        }
+    }
+
+    // throughput: fastest of the timed dense runs
+    if (!options.check_perf && !options.update_baselines && !options.update_golden) return result;
+    long long edges = 0;
+    for (const auto& neighbors : g.adjacency_list) edges += neighbors.size();
+    edges *= stack.size();
+
+    // a timed run repeats the forward pass until kMinTimedSeconds have passed,
+    // so tiny graphs are not measured at timer resolution
+    double best_seconds = 0.0;
+    for (int r = 0; r < max(1, options.repetitions); r++) {
+        Clock::time_point start = Clock::now();
+        int passes = 0;
+        double elapsed = 0.0;
+        do {
+            vector<vector<float>> out = stack.forward(g.node_features, g.adjacency_list);
+            passes++;
+            elapsed = chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < kMinTimedSeconds);
+        double seconds = elapsed / passes;
+        if (r == 0 || seconds < best_seconds) best_seconds = seconds;
+    }
+    result.edges_per_second = edges / max(best_seconds, 1e-9);
+
+    if (options.update_golden || options.update_baselines) {
+        baselines[c.name] = result.edges_per_second;
+    }
+    auto it = baselines.find(c.name);
+    if (it != baselines.end()) {
+        result.baseline_edges_per_second = it->second;
+        result.perf_ok = !options.check_perf
+            || result.edges_per_second >= (1.0 - options.perf_tolerance) * it->second;
+    }
+    return result;
+}
+
+}  // namespace
+
+vector<VerifyCase> read_verify_cases(const string& path) {
+    ifstream in(path);
+    if (!in) throw runtime_error("cannot open " + path);
+
+    vector<VerifyCase> cases;
+    string line;
+    while (getline(in, line)) {
+        if (line.find_first_not_of(" \t") == string::npos || line[line.find_first_not_of(" \t")] == '#') {
+            continue;
+        }
+        istringstream iss(line);
+        VerifyCase c;
+        if (!(iss >> c.name >> c.model_spec >> c.seed >> c.graph)) {
+            throw runtime_error(path + ": malformed case line: " + line);
+        }
+        cases.push_back(c);
+    }
+    return cases;
+}
+
+Graph synthetic_graph(int nodes, int avg_degree, int features, int hubs, uint64_t seed, int hub_degree) {
+    if (nodes < 1 || avg_degree < 0 || features < 1 || hubs < 0 || hub_degree < 0 || (hub_degree > 0 && nodes < 2)) {
+        throw invalid_argument("invalid synthetic graph parameters");
+    }
+    GraphBuilder builder(nodes, features);
+    int num_threads = default_thread_count();
+
+    // raw engine output only (no std distributions), so every platform builds the same graph;
+    // every block of nodes (and every random hub) draws from its own stream, so the
+    // edges do not depend on how the blocks are spread over the threads
+    long long num_blocks = (nodes + kSyntheticBlockNodes - 1) / kSyntheticBlockNodes;
+    parallel_for(0, num_blocks, num_threads, [&](long long begin, long long end, int) {
+        GraphBuilder::Writer writer = builder.writer();
+        for (long long b = begin; b < end; b++) {
+            mt19937_64 gen(derive_seed(derive_seed(seed, 2), b));
+            int last = static_cast<int>(min<long long>(nodes, (b + 1) * kSyntheticBlockNodes));
+            for (int i = static_cast<int>(b * kSyntheticBlockNodes); i < last; i++) {
+                for (int k = 0; k < avg_degree / 2; k++) {
+                    writer.add_edge(i, static_cast<int>(gen() % nodes));
+                }
+            }
+        }
+    });
+    parallel_for(0, min(hubs, nodes), num_threads, [&](long long begin, long long end, int) {
+        GraphBuilder::Writer writer = builder.writer();
+        for (int h = static_cast<int>(begin); h < end; h++) {
+            if (hub_degree > 0) {
+                for (int k = 0; k < hub_degree; k++) {
+                    writer.add_edge(h, (h + 1 + k % (nodes - 1)) % nodes);
+                }
+                continue;
+            }
+            mt19937_64 gen(derive_seed(derive_seed(seed, 3), h));
+            for (int i = 0; i < nodes; i++) {
+                if (i != h && gen() % 4 == 0) writer.add_edge(h, i);
+            }
+        }
+    });
+
+    vector<float> values(static_cast<size_t>(nodes) * features);
+    init_uniform(values, -1.0f, 1.0f, derive_seed(seed, 1));
+    parallel_for(0, nodes, num_threads, [&](long long begin, long long end, int) {
+        for (long long i = begin; i < end; i++) {
+            builder.set_node_feature(static_cast<int>(i), vector<float>(values.begin() + i * features,
+                                                                        values.begin() + (i + 1) * features));
+        }
+    });
+    return builder.build();
+}
+
+Graph load_verify_graph(const string& graph, const string& golden_dir) {
+    const string prefix = "synthetic:";
+    if (graph.compare(0, prefix.size(), prefix) == 0) {
+        vector<long long> fields;
+        istringstream iss(graph.substr(prefix.size()));
+        string field;
+        while (getline(iss, field, ':')) fields.push_back(stoll(field));
+        if (fields.size() != 5 && fields.size() != 6) {
+            throw invalid_argument("expected synthetic:<nodes>:<avg_degree>:<features>:<hubs>:<seed>[:<hub_degree>], got "
+                                   + graph);
+        }
+        return synthetic_graph(fields[0], fields[1], fields[2], fields[3], fields[4], fields.size() == 6 ? fields[5] : 0);
+    }
+
+    fs::path path(graph);
+    if (path.is_relative()) path = fs::path(golden_dir) / path;
+    ifstream in(path);
+    if (!in) throw runtime_error("cannot open graph file " + path.string());
+    return read_graph_from_stream(in);
+}
+
+vector<VerifyResult> run_verification(const VerifyOptions& options) {
+    vector<VerifyCase> cases = read_verify_cases((fs::path(options.golden_dir) / "cases.txt").string());
+    string baselines_path = (fs::path(options.golden_dir) / "baselines.txt").string();
+    map<string, double> baselines = read_baselines(baselines_path);
+
+    vector<VerifyResult> results;
+    for (const VerifyCase& c : cases) {
+        try {
+            results.push_back(run_case(c, options, baselines));
+        } catch (const exception& e) {
+            VerifyResult failed;
+            failed.name = c.name;
+            failed.error = e.what();
+            results.push_back(failed);
+        }
+    }
+
+    if (options.update_golden || options.update_baselines) {
+        write_baselines(baselines_path, baselines);
+    }
+    return results;
+}
@@ -0,0 +1,83 @@
+// Verification.h
+
+#pragma once
+#include "Graph.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Golden-output and throughput regression checking for the layer kernels.
+//
+// A golden directory holds
+//   cases.txt      one case per line: <name> <model_spec> <seed> <graph>
+//   baselines.txt  one line per case:  <name> <edges_per_second>
+//   <name>.npy     expected output of each case
+// <graph> is a graph file (relative paths are resolved against the golden
+// directory) or synthetic:<nodes>:<avg_degree>:<features>:<hubs>:<seed>[:<hub_degree>].
+// Lines starting with '#' are comments.
+//
+// Every case runs the model through each execution path (dense stack,
+// hub splitting, compressed adjacency, sparse inputs) and compares every
+// result with the golden tensor; the dense path is also timed.
+
+// One line of cases.txt
+struct VerifyCase {
+    string name;
+    string model_spec;   // see LayerStack::from_spec
+    uint64_t seed;       // weight seed
+    string graph;        // graph file or synthetic spec
+};
+
+struct VerifyOptions {
+    string golden_dir;
+    float abs_tolerance = 1e-5f;  // |out - golden| <= abs + rel * |golden|
+    float rel_tolerance = 1e-4f;
+    double perf_tolerance = 0.25; // fail below (1 - perf_tolerance) * baseline throughput
+    bool check_perf = true;
+    int repetitions = 5;          // timed dense runs (of at least 20 ms each); the fastest counts
+    bool update_golden = false;   // rewrite the golden tensors (implies update_baselines)
+    bool update_baselines = false;// rewrite baselines.txt with the measured throughput
+};
+
+// Outcome of one case
+struct VerifyResult {
+    string name;
+    string error;                 // set when the case could not be checked at all
+    bool outputs_ok = true;
+    float max_abs_error = 0.0f;   // worst over all execution paths
+    string worst_path;            // execution path with the largest error
+    double edges_per_second = 0.0;
+    double baseline_edges_per_second = 0.0; // 0 when no baseline is recorded
+    bool perf_ok = true;
+
+    bool passed() const { return error.empty() && outputs_ok && perf_ok; }
+
+    // measured throughput relative to the baseline (1 = unchanged), 0 without one
+    double speed_ratio() const {
+        return baseline_edges_per_second > 0 ? edges_per_second / baseline_edges_per_second : 0.0;
+    }
+};
+
+// Parses cases.txt; throws runtime_error for unreadable files or malformed lines
+vector<VerifyCase> read_verify_cases(const string& path);
+
+// Deterministic random graph: every node links to avg_degree / 2 random nodes
+// (undirected, so the mean degree is about avg_degree), and each of the first
+// 'hubs' nodes also links to a quarter of all nodes. With hub_degree > 0 hub h
+// instead adds hub_degree edges to the nodes h + 1, h + 2, ... (wrapping
+// around and repeating, so degrees can exceed the node count and consecutive
+// hubs are adjacent). Features are uniform in [-1, 1). Built on all cores
+// with GraphBuilder, so neighbour lists are sorted. Depends only on the
+// arguments, not on the platform or the thread count.
+Graph synthetic_graph(int nodes, int avg_degree, int features, int hubs, uint64_t seed, int hub_degree = 0);
+
+// Loads the graph of a case (file or synthetic spec, see above).
+// Throws runtime_error / invalid_argument on failure.
+Graph load_verify_graph(const string& graph, const string& golden_dir);
+
+// Runs every case of options.golden_dir. In update mode the golden tensors
+// and/or baselines are written instead of being compared against.
+// Throws runtime_error if cases.txt cannot be read or files cannot be written;
+// problems with a single case are reported in its result.
+vector<VerifyResult> run_verification(const VerifyOptions& options);
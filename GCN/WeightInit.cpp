@@ -0,0 +1,53 @@
+// WeightInit.cpp
+
+#include "WeightInit.h"
+#include "Parallel.h"
+#include <random>
+
+namespace {
+
+// values per independently seeded block
+const size_t kInitBlock = 1 << 16;
+
+// blocks below this total are filled on the calling thread
+const size_t kParallelThreshold = 1 << 20;
+
+// SplitMix64 finaliser: decorrelates nearby seeds
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void fill_block(float* out, size_t count, float low, float high, uint64_t seed) {
+    mt19937_64 gen(seed);
+    float scale = high - low;
+    for (size_t i = 0; i < count; i++) {
+        float unit = static_cast<float>(gen() >> 40) * (1.0f / 16777216.0f); // 24 bits -> [0, 1)
+        out[i] = low + unit * scale;
+    }
+}
+
+}  // namespace
+
+uint64_t derive_seed(uint64_t seed, uint64_t index) {
+    return mix(seed ^ mix(index));
+}
+
+uint64_t random_seed() {
+    random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+void init_uniform(vector<float>& weights, float low, float high, uint64_t seed) {
+    size_t n_blocks = (weights.size() + kInitBlock - 1) / kInitBlock;
+    int threads = weights.size() < kParallelThreshold ? 1 : default_thread_count();
+    parallel_for(0, n_blocks, threads, [&](long long first, long long last, int) {
+        for (long long b = first; b < last; b++) {
+            size_t begin = b * kInitBlock;
+            size_t count = min(kInitBlock, weights.size() - begin);
+            fill_block(weights.data() + begin, count, low, high, derive_seed(seed, b));
+        }
+    });
+}
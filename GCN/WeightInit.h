@@ -0,0 +1,21 @@
+// WeightInit.h
+
+#pragma once
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+// Fills 'weights' with values drawn uniformly from [low, high).
+// The values are generated in fixed blocks, each from its own mt19937_64
+// seeded from (seed, block index), and mapped to floats without
+// std::uniform_real_distribution. So the result depends only on 'seed' (not on
+// the thread count or the standard library), and large layers are filled in
+// parallel.
+void init_uniform(vector<float>& weights, float low, float high, uint64_t seed);
+
+// A fresh non-deterministic seed (random_device), for unseeded constructors
+uint64_t random_seed();
+
+// Derives an independent seed for sub-stream 'index' of 'seed'
+// (e.g. per layer of a stack, or attention vector vs. weight matrix)
+uint64_t derive_seed(uint64_t seed, uint64_t index);
@@ -0,0 +1,366 @@
+// batch_main.cpp
+//
+// Non-interactive batch driver: runs one model over many graph files.
+// Parsing, inference and output writing run as a bounded pipeline
+//   reader threads -> [parsed queue] -> inference workers -> [result queue] -> writer
+// so the three overlap; full queues block the stage in front (backpressure).
+//
+// Usage: graph_batch <model_spec> <graph_dir | manifest_file> <output_dir>
+//                    [--readers N] [--workers N] [--queue N] [--format npy|raw|text]
+//                    [--seed N] [--cache-mb N [--spill <file> [--spill-mb N]]]
+// model_spec is e.g. "gcn:16,sage:8" (see LayerStack::from_spec), a file holding
+// one, or a checkpoint file (see Checkpoint.h). --seed makes spec weights reproducible.
+// --cache-mb keeps up to N MB of layer outputs in an EmbeddingCache keyed on
+// graph content, so inputs that repeat an earlier graph (same features and
+// edges) are served from the cache; --spill moves outputs beyond the budget
+// to an mmap-backed file of --spill-mb MB (default 1024) instead of dropping them.
+// Results keep the input's relative path: <output_dir>/<dir>/<name>.emb<ext>.
+// Unknown options and inputs that would share an output file are rejected.
+
+#include "BoundedQueue.h"
+#include "Checkpoint.h"
+#include "EmbeddingCache.h"
+#include "Graph.h"
+#include "GraphReader.h"
+#include "LayerStack.h"
+#include "OutputWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+// Throughput counters of one pipeline stage
+struct StageCounters {
+    atomic<long long> items{0};
+    atomic<long long> busy_us{0};  // time spent doing the stage's work
+    atomic<long long> wait_us{0};  // time blocked on an empty input or full output queue
+};
+
+long long micros_since(Clock::time_point start) {
+    return chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count();
+}
+
+struct ParsedGraph {
+    size_t index;
+    string path;
+    unique_ptr<Graph> graph;
+};
+
+struct InferenceResult {
+    size_t index;
+    string path;
+    vector<vector<float>> features;
+};
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <model_spec> <graph_dir | manifest_file> <output_dir>"
+         << " [--readers N] [--workers N] [--queue N] [--format npy|raw|text] [--seed N]"
+         << " [--cache-mb N [--spill <file> [--spill-mb N]]]\n";
+}
+
+// Lists the graph files to process: every regular file of a directory
+// (sorted by name) or the non-empty lines of a manifest file
+vector<string> collect_inputs(const string& source) {
+    vector<string> paths;
+    if (fs::is_directory(source)) {
+        for (const auto& entry : fs::directory_iterator(source)) {
+            if (entry.is_regular_file()) paths.push_back(entry.path().string());
+        }
+        sort(paths.begin(), paths.end());
+    } else {
+        ifstream manifest(source);
+        string line;
+        while (getline(manifest, line)) {
+            if (!line.empty() && line[0] != '#') paths.push_back(line);
+        }
+    }
+    return paths;
+}
+
+// Output file of an input, relative to the output directory: the input's path
+// relative to the graph directory, or for manifests the listed path without its
+// root and leading ".." components, with the extension replaced. Keeping the
+// directories means a/g.txt and b/g.txt do not overwrite each other.
+fs::path output_name(const string& input, const string& source, bool source_is_dir, OutputWriter::Format format) {
+    fs::path path = fs::path(input).lexically_normal();
+    path = source_is_dir ? path.lexically_relative(fs::path(source).lexically_normal()) : path.relative_path();
+    fs::path name;
+    for (const auto& part : path) {
+        if (name.empty() && part == "..") continue;
+        name /= part;
+    }
+    return name.replace_extension(".emb" + OutputWriter::extension(format));
+}
+
+// A spec argument naming a readable file is replaced by the file's first line
+string load_spec(const string& arg) {
+    ifstream file(arg);
+    string spec;
+    if (file.is_open() && getline(file, spec)) return spec;
+    return arg;
+}
+
+void print_stage(const string& name, const StageCounters& c, double wall_seconds) {
+    double busy = c.busy_us / 1e6, wait = c.wait_us / 1e6;
+    cerr << name << ": " << c.items << " items"
+         << " | " << (wall_seconds > 0 ? c.items / wall_seconds : 0.0) << " items/s"
+         << " | busy " << busy << " s | waiting " << wait << " s\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    string model = argv[1];
+    string source = argv[2];
+    string output_dir = argv[3];
+
+    int num_readers = 2;
+    int num_workers = max(1u, thread::hardware_concurrency());
+    int queue_capacity = 16;
+    OutputWriter::Format format = OutputWriter::Format::Npy;
+    optional<uint64_t> seed;
+    int cache_mb = 0;
+    int spill_mb = 1024;
+    string spill_path;
+    for (int a = 4; a < argc; a += 2) {
+        string flag = argv[a];
+        if (a + 1 == argc) {
+            cerr << "Missing value for " << flag << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (flag == "--seed") {
+            seed = strtoull(argv[a + 1], nullptr, 10);
+            continue;
+        }
+        if (flag == "--spill") {
+            spill_path = argv[a + 1];
+            continue;
+        }
+        if (flag == "--format") {
+            try {
+                format = OutputWriter::parse_format(argv[a + 1]);
+            } catch (const exception& e) {
+                cerr << e.what() << "\n";
+                return 1;
+            }
+            continue;
+        }
+        int value = atoi(argv[a + 1]);
+        int* target = flag == "--readers" ? &num_readers
+                    : flag == "--workers" ? &num_workers
+                    : flag == "--queue" ? &queue_capacity
+                    : flag == "--cache-mb" ? &cache_mb
+                    : flag == "--spill-mb" ? &spill_mb
+                    : nullptr;
+        if (!target || value <= 0) {
+            cerr << (target ? "Invalid value for " : "Unknown option ") << flag << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+        *target = value;
+    }
+
+    if (!spill_path.empty() && cache_mb == 0) {
+        cerr << "--spill needs --cache-mb\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Content keys: every input is a new Graph object, so (id, version) would never hit
+    unique_ptr<EmbeddingCache> cache;
+    if (cache_mb > 0) {
+        EmbeddingCacheOptions cache_options;
+        cache_options.memory_budget_bytes = static_cast<size_t>(cache_mb) << 20;
+        cache_options.spill_path = spill_path;
+        cache_options.spill_budget_bytes = spill_path.empty() ? 0 : static_cast<size_t>(spill_mb) << 20;
+        cache_options.key_on_content = true;
+        try {
+            cache.reset(new EmbeddingCache(cache_options));
+        } catch (const exception& e) {
+            cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    vector<string> inputs = collect_inputs(source);
+    if (inputs.empty()) {
+        cerr << "No graph files found in " << source << "\n";
+        return 1;
+    }
+    fs::create_directories(output_dir);
+
+    // Output paths are fixed up front; two inputs mapping to one file is an error
+    vector<fs::path> outputs;
+    map<fs::path, size_t> output_owner;
+    bool source_is_dir = fs::is_directory(source);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        outputs.push_back(fs::path(output_dir) / output_name(inputs[i], source, source_is_dir, format));
+        auto [it, inserted] = output_owner.emplace(outputs.back(), i);
+        if (!inserted) {
+            cerr << "Inputs " << inputs[it->second] << " and " << inputs[i]
+                 << " would both be written to " << outputs.back().string() << "\n";
+            return 1;
+        }
+    }
+
+    // One stack per input feature dimension, built the first time it is needed.
+    // A checkpoint fixes the input dimension; graphs with another one fail.
+    map<int, unique_ptr<LayerStack>> stacks;
+    mutex stacks_mutex;
+    string spec;
+    try {
+        if (is_checkpoint_file(model)) {
+            unique_ptr<LayerStack> stack(new LayerStack(load_checkpoint(model)));
+            int input_dim = stack->get_input_dim();
+            stacks[input_dim] = std::move(stack);
+        } else {
+            // Validate the spec up front so a typo fails fast instead of per graph
+            spec = load_spec(model);
+            LayerStack::from_spec(spec, 1, 0);
+        }
+    } catch (const exception& e) {
+        cerr << "Invalid model: " << e.what() << "\n";
+        return 1;
+    }
+    auto stack_for = [&](int input_dim) -> const LayerStack& {
+        lock_guard<mutex> lock(stacks_mutex);
+        auto& stack = stacks[input_dim];
+        if (!stack) {
+            if (spec.empty()) {
+                throw runtime_error("checkpoint does not accept " + to_string(input_dim) + " input features");
+            }
+            stack.reset(new LayerStack(seed ? LayerStack::from_spec(spec, input_dim, *seed)
+                                            : LayerStack::from_spec(spec, input_dim)));
+        }
+        return *stack;
+    };
+
+    BoundedQueue<ParsedGraph> parsed(queue_capacity);
+    BoundedQueue<InferenceResult> results(queue_capacity);
+    StageCounters read_stats, infer_stats, write_stats;
+    atomic<size_t> next_input{0};
+    atomic<int> failures{0};
+    Clock::time_point start = Clock::now();
+
+    // Stage 1: readers
+    vector<thread> readers;
+    for (int r = 0; r < num_readers; r++) {
+        readers.emplace_back([&]() {
+            for (size_t i = next_input++; i < inputs.size(); i = next_input++) {
+                Clock::time_point t0 = Clock::now();
+                unique_ptr<Graph> graph;
+                ifstream infile(inputs[i]);
+                try {
+                    if (!infile.is_open()) throw runtime_error("cannot open file");
+                    graph.reset(new Graph(read_graph_from_stream(infile)));
+                } catch (const exception& e) {
+                    cerr << "Skipping " << inputs[i] << ": " << e.what() << "\n";
+                    failures++;
+                    continue;
+                }
+                read_stats.busy_us += micros_since(t0);
+                read_stats.items++;
+
+                Clock::time_point t1 = Clock::now();
+                parsed.push(ParsedGraph{i, inputs[i], std::move(graph)});
+                read_stats.wait_us += micros_since(t1);
+            }
+        });
+    }
+
+    // Stage 2: inference workers
+    vector<thread> workers;
+    for (int w = 0; w < num_workers; w++) {
+        workers.emplace_back([&]() {
+            while (true) {
+                Clock::time_point t0 = Clock::now();
+                optional<ParsedGraph> item = parsed.pop();
+                infer_stats.wait_us += micros_since(t0);
+                if (!item) break;
+
+                Clock::time_point t1 = Clock::now();
+                const Graph& g = *item->graph;
+                vector<vector<float>> features;
+                try {
+                    const LayerStack& stack = stack_for(g.num_node_features);
+                    features = cache ? cache->forward(stack, g) : stack.forward(g.node_features, g.adjacency_list);
+                } catch (const exception& e) {
+                    cerr << "Skipping " << item->path << ": " << e.what() << "\n";
+                    failures++;
+                    continue;
+                }
+                item->graph.reset(); // release the graph before queueing the result
+                infer_stats.busy_us += micros_since(t1);
+                infer_stats.items++;
+
+                Clock::time_point t2 = Clock::now();
+                results.push(InferenceResult{item->index, item->path, std::move(features)});
+                infer_stats.wait_us += micros_since(t2);
+            }
+        });
+    }
+
+    // Stage 3: writer
+    thread writer([&]() {
+        while (true) {
+            Clock::time_point t0 = Clock::now();
+            optional<InferenceResult> item = results.pop();
+            write_stats.wait_us += micros_since(t0);
+            if (!item) break;
+
+            Clock::time_point t1 = Clock::now();
+            const fs::path& out_path = outputs[item->index];
+            try {
+                fs::create_directories(out_path.parent_path());
+                OutputWriter::write_embeddings(out_path.string(), item->features, format);
+            } catch (const exception& e) {
+                cerr << e.what() << "\n";
+                failures++;
+                continue;
+            }
+            write_stats.busy_us += micros_since(t1);
+            write_stats.items++;
+        }
+    });
+
+    // Shut the pipeline down stage by stage
+    for (auto& t : readers) t.join();
+    parsed.close();
+    for (auto& t : workers) t.join();
+    results.close();
+    writer.join();
+
+    double wall = micros_since(start) / 1e6;
+    cerr << "Processed " << write_stats.items << "/" << inputs.size() << " graphs in "
+         << wall << " s (" << failures << " failed)\n";
+    print_stage("read ", read_stats, wall);
+    print_stage("infer", infer_stats, wall);
+    print_stage("write", write_stats, wall);
+    if (cache) {
+        EmbeddingCacheStats c = cache->stats();
+        cerr << "cache: " << c.full_hits << " hits | " << c.misses << " layers computed"
+             << " | " << c.evictions << " evictions (" << c.spills << " spilled)"
+             << " | " << (c.memory_bytes >> 20) << " MB in memory, "
+             << (c.spill_bytes >> 20) << " MB spilled\n";
+    }
+    return failures == 0 ? 0 : 2;
+}
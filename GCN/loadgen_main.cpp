@@ -0,0 +1,167 @@
+// loadgen_main.cpp
+//
+// Local load generator for InferenceSession: several client threads submit
+// small embedding lookups concurrently and the driver reports throughput,
+// latency percentiles and how well requests were batched.
+//
+// Usage: graph_loadgen <model_spec | checkpoint> <graph_file>
+//                      [--clients N] [--requests N] [--nodes N]
+//                      [--window-us N] [--max-batch N] [--workers N] [--seed N] [--verify]
+// --requests is per client, --nodes the number of random nodes per request.
+// --verify checks every answer against the full-graph forward pass and exits
+// with 2 on a mismatch.
+
+#include "Checkpoint.h"
+#include "Graph.h"
+#include "GraphReader.h"
+#include "InferenceSession.h"
+#include "LayerStack.h"
+#include "WeightInit.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+double percentile(vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <model_spec | checkpoint> <graph_file>"
+             << " [--clients N] [--requests N] [--nodes N] [--window-us N] [--max-batch N]"
+             << " [--workers N] [--seed N] [--verify]\n";
+        return 1;
+    }
+    string model = argv[1];
+    string graph_file = argv[2];
+
+    int clients = 8, requests_per_client = 200, nodes_per_request = 4;
+    SessionOptions options;
+    uint64_t seed = random_seed();
+    bool verify = false;
+    for (int a = 3; a < argc; a++) {
+        string flag = argv[a];
+        if (flag == "--verify") { verify = true; continue; }
+        if (a + 1 >= argc) break;
+        string value = argv[++a];
+        if (flag == "--seed") seed = strtoull(value.c_str(), nullptr, 10);
+        else if (flag == "--window-us") options.batch_window = chrono::microseconds(atoll(value.c_str()));
+        else if (atoi(value.c_str()) <= 0) continue;
+        else if (flag == "--clients") clients = atoi(value.c_str());
+        else if (flag == "--requests") requests_per_client = atoi(value.c_str());
+        else if (flag == "--nodes") nodes_per_request = atoi(value.c_str());
+        else if (flag == "--max-batch") options.max_batch_requests = atoi(value.c_str());
+        else if (flag == "--workers") options.num_workers = atoi(value.c_str());
+    }
+
+    Graph g = read_graph_from_file(graph_file);
+    if (g.num_nodes == 0) {
+        cerr << "Graph has no nodes\n";
+        return 1;
+    }
+
+    unique_ptr<LayerStack> stack;
+    try {
+        if (is_checkpoint_file(model)) {
+            stack.reset(new LayerStack(load_checkpoint(model)));
+        } else {
+            stack.reset(new LayerStack(LayerStack::from_spec(model, g.num_node_features, seed)));
+        }
+    } catch (const exception& e) {
+        cerr << "Invalid model: " << e.what() << "\n";
+        return 1;
+    }
+
+    unique_ptr<InferenceSession> session;
+    try {
+        session.reset(new InferenceSession(std::move(g), std::move(*stack), options));
+    } catch (const exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+
+    vector<vector<float>> expected;
+    if (verify) {
+        expected = session->model().forward(session->graph().node_features, session->graph().adjacency_list);
+    }
+
+    int num_nodes = session->graph().num_nodes;
+    vector<vector<double>> latencies(clients), queue_times(clients);
+    atomic<long long> mismatches{0}, failures{0};
+
+    Clock::time_point start = Clock::now();
+    vector<thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            mt19937_64 rng(derive_seed(seed, c + 1));
+            uniform_int_distribution<int> pick(0, num_nodes - 1);
+            for (int r = 0; r < requests_per_client; r++) {
+                vector<int> nodes(nodes_per_request);
+                for (int& node : nodes) node = pick(rng);
+                try {
+                    InferenceResult result = session->submit(nodes).get();
+                    latencies[c].push_back(result.timing.total_seconds);
+                    queue_times[c].push_back(result.timing.queue_seconds);
+                    if (verify) {
+                        for (size_t k = 0; k < nodes.size(); k++) {
+                            if (result.embeddings[k] != expected[nodes[k]]) mismatches++;
+                        }
+                    }
+                } catch (const exception&) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double wall = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> all_latencies, all_queue;
+    for (int c = 0; c < clients; c++) {
+        all_latencies.insert(all_latencies.end(), latencies[c].begin(), latencies[c].end());
+        all_queue.insert(all_queue.end(), queue_times[c].begin(), queue_times[c].end());
+    }
+    SessionStats stats = session->stats();
+
+    cout << "requests: " << all_latencies.size() << " in " << wall << " s"
+         << " | throughput: " << (wall > 0 ? all_latencies.size() / wall : 0.0) << " req/s\n";
+    cout << "latency ms | p50: " << percentile(all_latencies, 0.50) * 1e3
+         << " | p95: " << percentile(all_latencies, 0.95) * 1e3
+         << " | p99: " << percentile(all_latencies, 0.99) * 1e3
+         << " | queue p50: " << percentile(all_queue, 0.50) * 1e3 << "\n";
+    cout << "batches: " << stats.batches
+         << " | requests per batch: " << stats.mean_batch_requests()
+         << " | computed nodes per batch: "
+         << (stats.batches ? static_cast<double>(stats.computed_nodes) / stats.batches : 0.0) << "\n";
+
+    if (failures > 0) {
+        cerr << failures << " requests failed\n";
+        return 1;
+    }
+    if (verify) {
+        if (mismatches > 0) {
+            cerr << mismatches << " embeddings differ from the full-graph forward pass\n";
+            return 2;
+        }
+        cout << "All embeddings match the full-graph forward pass\n";
+    }
+    return 0;
+}
@@ -4,46 +4,206 @@
 #include "GraphReader.h"        // read_graph_from_file(...)
 #include "GCNL.h"               // your existing GCNLayer
 #include "output.h"             // OutputConverter API
+#include "Numa.h"               // NUMA-aware placement (--numa)
+#include "Partition.h"          // partition-parallel execution (--partitions)
+#include "OutputWriter.h"       // binary / buffered result files (--out)
+#include "HubSplit.h"           // degree-aware execution (--hub-threshold)
+#include "Verification.h"       // golden-output / throughput checks (--verify)
+#include "Readout.h"            // node scores and graph pooling (--readout)
+#include "WeightInit.h"         // random_seed() when no --seed is given
 #include <iostream>
 #include <vector>
-#include <numeric>
 #include <functional>           // for function
+#include <cstdio>
+
+void print_usage(const char* program) {
+    cerr << "Usage: " << program << " <graph_input_file> [output_dim] [--numa] [--seed N]"
+         << " [--partitions K] [--hub-threshold N]"
+         << " [--readout sum|mean|max|min|attention] [--out <prefix> [--format npy|raw|text]]\n"
+         << "       " << program << " --verify <golden_dir> [--update-golden | --update-baselines]"
+         << " [--perf-tolerance X] [--no-perf]\n";
+}
+
+// --verify mode: checks every case of a golden directory (see Verification.h)
+// and prints one line per case. Returns 0 if all pass, 2 otherwise.
+int run_verify_mode(const VerifyOptions& options) {
+    vector<VerifyResult> results = run_verification(options);
+    int failures = 0;
+    for (const VerifyResult& r : results) {
+        char line[256];
+        if (!r.error.empty()) {
+            snprintf(line, sizeof(line), "%-18s FAIL  %s", r.name.c_str(), r.error.c_str());
+        } else {
+            snprintf(line, sizeof(line), "%-18s %s  max err %.2e (%s)",
+                     r.name.c_str(), r.passed() ? "ok  " : "FAIL", r.max_abs_error,
+                     r.worst_path.c_str());
+        }
+        cout << line;
+        if (r.edges_per_second > 0) {
+            snprintf(line, sizeof(line), " | %.3g edges/s", r.edges_per_second);
+            cout << line;
+        }
+        if (r.error.empty() && r.baseline_edges_per_second > 0) {
+            snprintf(line, sizeof(line), " | baseline %.3g (%+.0f%%)",
+                     r.baseline_edges_per_second, (r.speed_ratio() - 1.0) * 100.0);
+            cout << line;
+        }
+        if (r.error.empty() && !r.outputs_ok) cout << " | outputs outside tolerance";
+        if (!r.perf_ok) cout << " | throughput regression";
+        cout << "\n";
+        if (!r.passed()) failures++;
+    }
+    if (options.update_golden || options.update_baselines) {
+        cout << "Updated " << (options.update_golden ? "golden tensors and " : "")
+             << "baselines in " << options.golden_dir << "\n";
+    }
+    cout << results.size() - failures << "/" << results.size() << " cases passed\n";
+    return failures == 0 ? 0 : 2;
+}
 
 int main(int argc, char** argv) {
-    // 1) Grab the input filename
-    if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <graph_input_file>\n";
+    // 1) Grab the input filename (and optional output dimension / flags)
+    //    --out <prefix> writes results to files instead of printing every value
+    //    --readout sum|mean|max|min|attention also pools the embeddings into one graph vector
+    //    --verify <golden_dir> runs the regression checks instead (no graph file;
+    //      --update-golden / --update-baselines rewrite the stored references,
+    //      --perf-tolerance X sets the allowed throughput drop, --no-perf skips it)
+    string filename;
+    string out_prefix;
+    OutputWriter::Format out_format = OutputWriter::Format::Npy;
+    int out_dim = 0;
+    uint64_t seed = random_seed();
+    bool use_numa = false;
+    int num_partitions = 0;
+    int hub_threshold = 0;
+    string readout_name;
+    OutputConverter::Pooling pooling = OutputConverter::Pooling::Mean;
+    VerifyOptions verify;
+    try {
+        for (int a = 1; a < argc; a++) {
+            string arg = argv[a];
+            if (arg == "--numa") use_numa = true;
+            else if (arg == "--update-golden") verify.update_golden = true;
+            else if (arg == "--update-baselines") verify.update_baselines = true;
+            else if (arg == "--no-perf") verify.check_perf = false;
+            else if (arg.compare(0, 2, "--") == 0) {
+                // every remaining flag takes a value
+                bool known = arg == "--out" || arg == "--format" || arg == "--seed" || arg == "--partitions"
+                          || arg == "--hub-threshold" || arg == "--readout" || arg == "--verify"
+                          || arg == "--perf-tolerance";
+                if (!known) throw invalid_argument("Unknown option " + arg);
+                if (a + 1 == argc) throw invalid_argument("Missing value for " + arg);
+                string value = argv[++a];
+                if (arg == "--out") out_prefix = value;
+                else if (arg == "--format") out_format = OutputWriter::parse_format(value);
+                else if (arg == "--seed") seed = strtoull(value.c_str(), nullptr, 10);
+                else if (arg == "--partitions") num_partitions = atoi(value.c_str());
+                else if (arg == "--hub-threshold") hub_threshold = atoi(value.c_str());
+                else if (arg == "--readout") pooling = OutputConverter::parsePooling(readout_name = value);
+                else if (arg == "--verify") verify.golden_dir = value;
+                else verify.perf_tolerance = atof(value.c_str());
+            }
+            else if (filename.empty()) filename = arg;
+            else if (out_dim == 0) out_dim = atoi(arg.c_str());
+            else throw invalid_argument("Unexpected argument " + arg);
+        }
+        // the execution modes replace each other, so at most one may be chosen
+        if (use_numa + (num_partitions > 0) + (hub_threshold > 0) > 1) {
+            throw invalid_argument("--numa, --partitions and --hub-threshold cannot be combined");
+        }
+    } catch (const invalid_argument& e) {
+        // unknown or incomplete option, unknown --format / --readout value
+        cerr << e.what() << "\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (!verify.golden_dir.empty()) {
+        try {
+            return run_verify_mode(verify);
+        } catch (const exception& e) {
+            cerr << "Verification failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (filename.empty()) {
+        print_usage(argv[0]);
         return 1;
     }
-    string filename = argv[1];
 
     // 2) Read the graph
     Graph g = read_graph_from_file(filename);
 
-    // 3) Run one GCN layer
-    cout << "Enter output feature dimension: ";
-    int out_dim;
-    cin >> out_dim;
+    // 3) Run one GCN layer (prompt for the dimension only if it was not given)
+    if (out_dim <= 0) {
+        cout << "Enter output feature dimension: ";
+        cin >> out_dim;
+    }
+
+    GCNLayer gcn(g.num_node_features, out_dim, seed);
+    vector<vector<float>> features;
+    if (use_numa) {
+        // rows were first-touched by the reader thread; move them to their home nodes
+        NumaPlacement placement(NumaTopology::detect(), g.num_nodes);
+        placement.place_rows(g.node_features);
+        features = placement.forward(gcn, g.node_features, g.adjacency_list);
+
+        NumaAccessStats stats = placement.access_stats(g.adjacency_list);
+        cerr << "NUMA nodes: " << placement.topology().num_nodes()
+             << (placement.topology().is_numa() ? "" : " (no NUMA, single-node fallback)")
+             << " | local reads: " << stats.local_reads
+             << " | remote reads: " << stats.remote_reads
+             << " | local ratio: " << stats.local_ratio() << "\n";
+    } else if (num_partitions > 0) {
+        // one thread per part over its local graph, halo rows exchanged between layers
+        vector<int> part_of = partition_graph(g.adjacency_list, num_partitions);
+        PartitionMetrics metrics = evaluate_partition(g.adjacency_list, part_of, num_partitions);
+        PartitionedExecutor executor(g.adjacency_list, part_of, num_partitions);
+        features = executor.forward(gcn, g.node_features);
 
-    GCNLayer gcn(g.num_node_features, out_dim);
-    auto features = gcn.forward(g.node_features, g.adjacency_list);
+        cerr << "Partitions: " << num_partitions
+             << " | edge cut: " << metrics.cut_edges << "/" << metrics.total_edges
+             << " (" << metrics.cut_fraction() << ")"
+             << " | imbalance: " << metrics.imbalance()
+             << " | halo nodes: " << metrics.halo_nodes << "\n";
+    } else if (hub_threshold > 0) {
+        // neighbour lists above the threshold are split across workers and merged
+        HubSplitOptions options;
+        options.degree_threshold = hub_threshold;
+        HubSplitPlan plan = plan_hub_split(g.adjacency_list, options);
+        features = gcn.forward_split(g.node_features, g.adjacency_list, options);
 
-    cout << "=== Node Features (post-GCN) ===\n";
-    for (size_t i = 0; i < features.size(); ++i) {
-        cout << "Node " << i << ": ";
-        for (float val : features[i]) {
-            cout << val << " ";
+        cerr << "Hub nodes: " << plan.hubs.size()
+             << " | segments: " << plan.segments.size()
+             << " | light chunks: " << plan.light_chunks.size() << "\n";
+    } else {
+        features = gcn.forward(g.node_features, g.adjacency_list);
+    }
+
+    if (out_prefix.empty()) {
+        cout << "=== Node Features (post-GCN) ===\n";
+        for (size_t i = 0; i < features.size(); ++i) {
+            cout << "Node " << i << ": ";
+            for (float val : features[i]) {
+                cout << val << " ";
+            }
+            cout << "\n";
         }
         cout << "\n";
     }
-    cout << "\n";
 
     // 4) Compute node‐level scores (sum of features)
-    vector<float> nodeScores;
-    nodeScores.reserve(features.size());
-    for (auto &feat : features) {
-        float sum = accumulate(feat.begin(), feat.end(), 0.0f);
-        nodeScores.push_back(sum);
+    vector<float> nodeScores = OutputConverter::rowSums(features);
+
+    // Optional graph-level readout straight from the embedding matrix
+    vector<float> graphEmbedding;
+    if (!readout_name.empty()) {
+        OutputConverter::ReadoutOptions readoutOptions;
+        if (pooling == OutputConverter::Pooling::Attention) {
+            // no trained gate here: draw one from the model seed
+            readoutOptions.attention_gate.resize(out_dim);
+            init_uniform(readoutOptions.attention_gate, -1.0f, 1.0f, derive_seed(seed, 1));
+        }
+        graphEmbedding = OutputConverter::readout(features, pooling, readoutOptions);
     }
 
     // 5) Define CUSTOM edge‐combiner and graph‐aggregator
@@ -88,10 +248,29 @@ int main(int argc, char** argv) {
         OutputConverter::DefaultAgg::meanGraph  // same aggregator
     );
 
-    // 7) Print results
+    // 7) Print results (or write them to files)
     cout << "=== Graph‐Level ===\n";
     cout << "Score = " << graphScore
-              << "\n\n";
+              << "\n";
+    if (!readout_name.empty()) {
+        cout << "Readout (" << readout_name << ") =";
+        for (float val : graphEmbedding) cout << " " << val;
+        cout << "\n";
+    }
+    cout << "\n";
+
+    if (!out_prefix.empty()) {
+        string ext = OutputWriter::extension(out_format);
+        OutputWriter::write_embeddings(out_prefix + ".emb" + ext, features, out_format);
+        OutputWriter::write_scores(out_prefix + ".edges" + ext, edgeScores, out_format);
+        OutputWriter::write_binary(out_prefix + ".edgebin" + ext, edgeTruth, out_format);
+        if (!readout_name.empty()) {
+            OutputWriter::write_scores(out_prefix + ".graph" + ext, graphEmbedding, out_format);
+        }
+        cout << "Wrote " << out_prefix << ".{emb,edges,edgebin" << (readout_name.empty() ? "" : ",graph")
+             << "}" << ext << "\n";
+        return 0;
+    }
 
     cout << "=== Edge‐Level ===\n";
     for (size_t i = 0; i < edgeScores.size(); ++i) {
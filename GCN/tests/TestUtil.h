@@ -0,0 +1,58 @@
+// TestUtil.h
+
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Minimal helpers for the ctest programs in this directory: failed checks are
+// printed and counted, and main returns test_result().
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "FAIL: " << what << "\n";
+        test_failures()++;
+    }
+}
+
+inline int test_result() {
+    if (test_failures() > 0) {
+        cerr << test_failures() << " check(s) failed\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Deterministic uniform values in [low, high) from raw engine output
+// (no std distributions, so every platform sees the same data)
+inline float uniform(mt19937_64& gen, float low, float high) {
+    return low + (high - low) * static_cast<float>(gen() >> 40) * (1.0f / 16777216.0f);
+}
+
+inline vector<vector<float>> random_matrix(mt19937_64& gen, int rows, int cols) {
+    vector<vector<float>> m(rows, vector<float>(cols));
+    for (auto& row : m) {
+        for (float& v : row) v = uniform(gen, -1.0f, 1.0f);
+    }
+    return m;
+}
+
+// Undirected random graph without self-loops
+inline vector<vector<int>> random_graph(mt19937_64& gen, int nodes, int edges) {
+    vector<vector<int>> adjacency(nodes);
+    for (int e = 0; e < edges; e++) {
+        int a = gen() % nodes, b = gen() % nodes;
+        if (a == b) continue;
+        adjacency[a].push_back(b);
+        adjacency[b].push_back(a);
+    }
+    return adjacency;
+}
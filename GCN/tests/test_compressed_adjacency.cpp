@@ -0,0 +1,99 @@
+// test_compressed_adjacency.cpp
+//
+// CompressedAdjacency must give back the sorted input lists (through
+// to_adjacency_list, decode and the iterator) for degrees around the block
+// size and for gaps that need 5-byte varints at the very end of the stream,
+// and contains() must be exact on both sides of every skip entry.
+
+#include "CompressedAdjacency.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+const int kBlock = CompressedAdjacency::kBlockSize;
+
+// Sorted ids with gaps in [min_gap, max_gap]; gap 0 makes duplicates
+vector<int> random_list(mt19937_64& gen, int degree, int min_gap, int max_gap) {
+    vector<int> list;
+    long long id = gen() % 16;
+    for (int k = 0; k < degree; k++) {
+        list.push_back(static_cast<int>(id));
+        id += min_gap + static_cast<long long>(gen() % (max_gap - min_gap + 1));
+    }
+    return list;
+}
+
+vector<vector<int>> test_lists() {
+    mt19937_64 gen(26);
+    vector<vector<int>> lists;
+    for (int degree : {0, 1, kBlock - 1, kBlock, kBlock + 1, 0, 2 * kBlock + 1, 300}) {
+        lists.push_back(random_list(gen, degree, 2, 1000)); // gaps >= 2 leave absent ids between neighbours
+    }
+    lists.push_back(random_list(gen, 3 * kBlock, 0, 3));     // duplicates, also across block boundaries
+    lists.push_back(random_list(gen, kBlock + 5, 1 << 20, 1 << 24));
+    // gaps of 2^28 and more take 5-byte varints; as the last list they end
+    // right before the padding that the word-wise decoder reads into
+    lists.push_back({7, 7 + (1 << 28), 8 + (1 << 29), 9 + (3 << 29), INT_MAX});
+
+    // the encoder sorts: hand it shuffled lists
+    for (auto& list : lists) shuffle(list.begin(), list.end(), gen);
+    return lists;
+}
+
+void check_round_trip(const vector<vector<int>>& lists, const CompressedAdjacency& compressed) {
+    check(compressed.num_nodes() == static_cast<int>(lists.size()), "wrong node count");
+    vector<vector<int>> decoded = compressed.to_adjacency_list();
+    vector<int> out;
+    for (size_t node = 0; node < lists.size() && node < decoded.size(); node++) {
+        vector<int> sorted = lists[node];
+        sort(sorted.begin(), sorted.end());
+        string name = "node " + to_string(node) + " (degree " + to_string(sorted.size()) + ")";
+
+        check(compressed.degree(node) == static_cast<int>(sorted.size()), name + ": wrong degree");
+        check(decoded[node] == sorted, name + ": to_adjacency_list differs");
+        compressed.decode(node, out);
+        check(out == sorted, name + ": decode differs");
+        vector<int> iterated;
+        for (int neighbor : compressed.neighbors(node)) iterated.push_back(neighbor);
+        check(iterated == sorted, name + ": iterator differs");
+    }
+}
+
+void check_contains(const vector<vector<int>>& lists, const CompressedAdjacency& compressed) {
+    for (size_t node = 0; node < lists.size(); node++) {
+        vector<int> sorted = lists[node];
+        sort(sorted.begin(), sorted.end());
+        string name = "node " + to_string(node);
+        auto present = [&](long long id) { return binary_search(sorted.begin(), sorted.end(), id); };
+        auto expect = [&](long long id) {
+            if (id < 0 || id > INT_MAX) return;
+            check(compressed.contains(node, static_cast<int>(id)) == present(id),
+                  name + ": contains(" + to_string(id) + ") should be " + (present(id) ? "true" : "false"));
+        };
+
+        for (int id : sorted) expect(id);
+        expect(-1 + (sorted.empty() ? 1 : sorted.front()));
+        expect(1 + (sorted.empty() ? 0 : static_cast<long long>(sorted.back())));
+        // skip entry k / kBlock starts from sorted[k - 1]: probe ids just below,
+        // at and above both ends of the boundary
+        for (size_t k = kBlock; k < sorted.size(); k += kBlock) {
+            for (long long delta : {-1, 0, 1}) {
+                expect(sorted[k - 1] + delta);
+                expect(sorted[k] + delta);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    vector<vector<int>> lists = test_lists();
+    CompressedAdjacency compressed(lists);
+    check_round_trip(lists, compressed);
+    check_contains(lists, compressed);
+    check(CompressedAdjacency().num_nodes() == 0, "default-constructed adjacency is not empty");
+    return test_result();
+}
@@ -0,0 +1,159 @@
+// test_embedding_cache.cpp
+//
+// EmbeddingCache must return exactly what LayerStack::forward returns: after
+// edge updates (rows patched in place), when outputs are evicted to and
+// reloaded from the spill file, when a longer stack resumes from a cached
+// prefix, and with content keys after direct member writes.
+
+#include "EmbeddingCache.h"
+#include "LayerStack.h"
+#include "TestUtil.h"
+#include <filesystem>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int kNodes = 200;
+const int kFeatures = 8;
+const char* kSpec = "gcn:16,sage:8,gat:4";
+
+Graph make_graph(uint64_t seed) {
+    mt19937_64 gen(seed);
+    Graph g(kNodes, kFeatures);
+    for (int i = 0; i < kNodes; i++) {
+        g.set_node_feature(i, random_matrix(gen, 1, kFeatures)[0]);
+    }
+    vector<vector<int>> adjacency = random_graph(gen, kNodes, 3 * kNodes);
+    for (int a = 0; a < kNodes; a++) {
+        for (int b : adjacency[a]) {
+            if (a < b) g.add_edge(a, b);
+        }
+    }
+    return g;
+}
+
+vector<vector<float>> reference(const LayerStack& stack, const Graph& g) {
+    return stack.forward(g.node_features, g.adjacency_list);
+}
+
+string spill_file() {
+    return (fs::temp_directory_path() / ("test_embedding_cache." + to_string(getpid()) + ".spill")).string();
+}
+
+// Edge updates patch only the reachable rows and stay bit-identical
+void check_incremental() {
+    Graph g = make_graph(1);
+    LayerStack stack = LayerStack::from_spec(kSpec, kFeatures, 11);
+    EmbeddingCache cache;
+
+    check(cache.forward(stack, g) == reference(stack, g), "cold forward differs");
+    check(cache.forward(stack, g) == reference(stack, g), "warm forward differs");
+    EmbeddingCacheStats stats = cache.stats();
+    check(stats.misses == 3 && stats.full_hits == 1, "expected 3 misses and 1 full hit");
+
+    mt19937_64 gen(2);
+    for (int round = 0; round < 5; round++) {
+        vector<pair<int, int>> edges;
+        for (int e = 0; e < 2; e++) edges.emplace_back(gen() % kNodes, gen() % kNodes);
+        cache.add_edges(g, edges);
+        check(cache.forward(stack, g) == reference(stack, g),
+              "forward after add_edges differs (round " + to_string(round) + ")");
+    }
+    stats = cache.stats();
+    check(stats.partial_hits > 0, "edge updates were not patched incrementally");
+    check(stats.rows_recomputed < 3LL * kNodes * stats.partial_hits, "patching recomputed every row");
+}
+
+// A budget smaller than one graph's outputs forces evictions into the spill
+// file; reloading them must give the same values
+void check_spill() {
+    size_t layer_bytes = kNodes * 16 * sizeof(float); // widest layer output
+    EmbeddingCacheOptions options;
+    options.memory_budget_bytes = layer_bytes + layer_bytes / 2;
+    options.spill_path = spill_file();
+    options.spill_budget_bytes = 1 << 20;
+
+    LayerStack stack = LayerStack::from_spec(kSpec, kFeatures, 12);
+    Graph first = make_graph(3);
+    Graph second = make_graph(4);
+    {
+        EmbeddingCache cache(options);
+        vector<vector<float>> expected_first = reference(stack, first);
+        vector<vector<float>> expected_second = reference(stack, second);
+        check(cache.forward(stack, first) == expected_first, "first graph differs");
+        check(cache.forward(stack, second) == expected_second, "second graph differs");
+        EmbeddingCacheStats stats = cache.stats();
+        check(stats.evictions > 0 && stats.spills > 0, "small budget did not spill");
+        check(stats.memory_bytes <= options.memory_budget_bytes, "memory budget exceeded");
+
+        // the first graph's final output was spilled: reload it
+        EmbeddingCacheStats before = stats;
+        check(cache.forward(stack, first) == expected_first, "output reloaded from the spill file differs");
+        stats = cache.stats();
+        check(stats.misses == before.misses, "spilled output was recomputed instead of reloaded");
+        check(stats.spill_bytes < before.spill_bytes, "output was not read back from the spill file");
+        check(fs::exists(options.spill_path), "spill file missing while the cache is alive");
+    }
+    check(!fs::exists(options.spill_path), "spill file left behind");
+
+    // without a spill file evicted outputs are simply recomputed
+    options.spill_path.clear();
+    EmbeddingCache cache(options);
+    cache.forward(stack, first);
+    cache.forward(stack, second);
+    check(cache.forward(stack, first) == reference(stack, first), "recomputed output differs");
+    check(cache.stats().spills == 0, "spilled without a spill file");
+}
+
+// A stack extending a cached one runs only its new layers
+void check_prefix_resume() {
+    Graph g = make_graph(5);
+    LayerStack shorter = LayerStack::from_spec("gcn:16,sage:8", kFeatures, 13);
+    LayerStack longer = LayerStack::from_spec(kSpec, kFeatures, 13);
+    vector<uint64_t> short_hashes = layer_prefix_hashes(shorter);
+    vector<uint64_t> long_hashes = layer_prefix_hashes(longer);
+    check(vector<uint64_t>(long_hashes.begin(), long_hashes.begin() + 2) == short_hashes,
+          "prefix hashes of equal leading layers differ");
+
+    EmbeddingCache cache;
+    cache.forward(shorter, g);
+    EmbeddingCacheStats before = cache.stats();
+    check(cache.forward(longer, g) == reference(longer, g), "resumed forward differs");
+    EmbeddingCacheStats after = cache.stats();
+    check(after.misses - before.misses == 1, "resumed stack recomputed its cached prefix");
+    check(after.full_hits - before.full_hits == 1, "resumed stack did not load the cached prefix");
+}
+
+// Content keys catch writes that bypass the Graph API and share equal graphs
+void check_content_keys() {
+    EmbeddingCacheOptions options;
+    options.key_on_content = true;
+    EmbeddingCache cache(options);
+    LayerStack stack = LayerStack::from_spec(kSpec, kFeatures, 14);
+
+    Graph g = make_graph(6);
+    cache.forward(stack, g);
+    g.node_features[7][0] += 1.0f; // no touch()
+    check(cache.forward(stack, g) == reference(stack, g), "direct feature write served stale rows");
+
+    Graph copy = make_graph(6);
+    copy.node_features[7][0] += 1.0f;
+    long long misses = cache.stats().misses;
+    check(cache.forward(stack, copy) == reference(stack, copy), "equal graph differs");
+    check(cache.stats().misses == misses, "equal graph loaded separately missed the cache");
+
+    cache.add_edges(g, {{1, 2}, {3, 4}});
+    check(cache.forward(stack, g) == reference(stack, g), "forward after add_edges differs (content keys)");
+}
+
+}  // namespace
+
+int main() {
+    check_incremental();
+    check_spill();
+    check_prefix_resume();
+    check_content_keys();
+    return test_result();
+}
@@ -0,0 +1,199 @@
+// test_gradients.cpp
+//
+// Checks the backward passes of every layer type against finite
+// differences (parameters and inputs, with and without stored intermediates),
+// checks that stale or mismatched intermediates are never used, and trains small stacks on a separable toy problem (chance level is 1/3;
+// the ReLU on the output layer keeps GCN stacks below 0.9).
+
+#include "GATL.h"
+#include "GCNL.h"
+#include "GraphSage.h"
+#include "LayerStack.h"
+#include "Loss.h"
+#include "Optimizer.h"
+#include "TestUtil.h"
+#include "Trainer.h"
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+const float kEpsilon = 1e-3f;     // finite-difference step
+const double kTolerance = 2e-2;   // allowed |fd - analytic| / (0.01 + |fd|)
+
+// Scalar loss sum(out * weights), so dLoss/dOut = weights
+double weighted_output(
+    BaseLayer& layer,
+    const vector<vector<float>>& x,
+    const vector<vector<int>>& adjacency,
+    const vector<vector<float>>& weights
+) {
+    vector<vector<float>> out = layer.forward(x, adjacency);
+    double loss = 0.0;
+    for (size_t i = 0; i < out.size(); i++) {
+        for (size_t o = 0; o < out[i].size(); o++) loss += out[i][o] * weights[i][o];
+    }
+    return loss;
+}
+
+// Relative error of an analytic derivative against finite differences.
+// ReLU makes the loss piecewise smooth: when the step crosses a kink the
+// central difference is off, but one of the one-sided differences still
+// matches, so the best of the three is taken.
+double gradient_error(
+    float analytic,
+    float& value,
+    BaseLayer& layer,
+    const vector<vector<float>>& x,
+    const vector<vector<int>>& adjacency,
+    const vector<vector<float>>& weights
+) {
+    float saved = value;
+    double center = weighted_output(layer, x, adjacency, weights);
+    value = saved + kEpsilon;
+    double plus = weighted_output(layer, x, adjacency, weights);
+    value = saved - kEpsilon;
+    double minus = weighted_output(layer, x, adjacency, weights);
+    value = saved;
+
+    double error = 1e30;
+    for (double fd : {(plus - minus) / (2.0 * kEpsilon), (plus - center) / kEpsilon, (center - minus) / kEpsilon}) {
+        error = min(error, fabs(fd - analytic) / (1e-2 + fabs(fd)));
+    }
+    return error;
+}
+
+void check_layer(BaseLayer& layer, bool keep_intermediates, uint64_t seed) {
+    string name = layer.type_name() + (keep_intermediates ? " (stored)" : " (recomputed)");
+    mt19937_64 gen(seed);
+    int n = 12;
+    vector<vector<float>> x = random_matrix(gen, n, layer.get_input_dim());
+    vector<vector<float>> weights = random_matrix(gen, n, layer.get_output_dim());
+    vector<vector<int>> adjacency = random_graph(gen, n, 20);
+
+    layer.zero_gradients();
+    vector<vector<float>> out = layer.forward_train(x, adjacency, keep_intermediates);
+    check(out == layer.forward(x, adjacency), name + ": forward_train differs from forward");
+    vector<vector<float>> grad_x = layer.backward(x, adjacency, out, weights);
+
+    double worst = 0.0;
+    vector<vector<float>*> params = layer.parameters();
+    vector<vector<float>*> grads = layer.gradients();
+    for (size_t k = 0; k < params.size(); k++) {
+        for (size_t i = 0; i < params[k]->size(); i += 3) {
+            worst = max(worst, gradient_error((*grads[k])[i], (*params[k])[i], layer, x, adjacency, weights));
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        for (int d = 0; d < layer.get_input_dim(); d++) {
+            worst = max(worst, gradient_error(grad_x[i][d], x[i][d], layer, x, adjacency, weights));
+        }
+    }
+    check(worst < kTolerance, name + ": gradient error " + to_string(worst));
+}
+
+// A forward_train without intermediates must drop the ones of an earlier call,
+// and intermediates kept for a different input must be rejected
+void check_stale_intermediates(BaseLayer& layer, uint64_t seed) {
+    string name = layer.type_name();
+    mt19937_64 gen(seed);
+    int n = 12;
+    vector<vector<float>> first = random_matrix(gen, n, layer.get_input_dim());
+    vector<vector<float>> second = random_matrix(gen, n, layer.get_input_dim());
+    vector<vector<float>> weights = random_matrix(gen, n, layer.get_output_dim());
+    vector<vector<int>> adjacency = random_graph(gen, n, 20);
+
+    // input and parameter gradients of one backward pass
+    auto gradients_of = [&](const vector<vector<float>>& out) {
+        layer.zero_gradients();
+        vector<vector<float>> all = layer.backward(second, adjacency, out, weights);
+        for (vector<float>* grad : layer.gradients()) all.push_back(*grad);
+        return all;
+    };
+    vector<vector<float>> expected = gradients_of(layer.forward_train(second, adjacency, false));
+    layer.forward_train(first, adjacency, true);
+    check(gradients_of(layer.forward_train(second, adjacency, false)) == expected,
+          name + ": backward used stale intermediates");
+
+    layer.forward_train(first, adjacency, true);
+    vector<vector<float>> fewer(second.begin(), second.begin() + n / 2);
+    vector<vector<int>> fewer_adjacency(n / 2);
+    bool thrown = false;
+    try {
+        layer.backward(fewer, fewer_adjacency, vector<vector<float>>(fewer.size(), weights[0]), weights);
+    } catch (const logic_error&) {
+        thrown = true;
+    }
+    check(thrown, name + ": intermediates of a different input accepted");
+    layer.zero_gradients();
+}
+
+// Three classes whose features and edges are both informative
+void toy_problem(vector<vector<float>>& x, vector<vector<int>>& adjacency, vector<int>& labels) {
+    mt19937_64 gen(17);
+    int n = 60;
+    x = random_matrix(gen, n, 8);
+    adjacency.assign(n, {});
+    labels.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        labels[i] = i % 3;
+        for (int d = labels[i]; d < 8; d += 3) x[i][d] += 1.5f;
+    }
+    for (int e = 0; e < 150; e++) {
+        int a = gen() % n, b = gen() % n;
+        if (a == b || a % 3 != b % 3) continue;
+        adjacency[a].push_back(b);
+        adjacency[b].push_back(a);
+    }
+    for (int i = 0; i < n; i += 5) labels[i] = kIgnoreLabel;
+}
+
+void check_training(const string& spec) {
+    vector<vector<float>> x;
+    vector<vector<int>> adjacency;
+    vector<int> labels;
+    toy_problem(x, adjacency, labels);
+
+    // activation checkpointing must not change the numbers
+    vector<float> losses[2];
+    for (int stored = 0; stored < 2; stored++) {
+        LayerStack stack = LayerStack::from_spec(spec, 8, 7);
+        Adam adam(0.01f);
+        Trainer trainer(stack, adam);
+        trainer.set_activation_checkpointing(stored == 0);
+        for (int epoch = 0; epoch < 100; epoch++) {
+            losses[stored].push_back(trainer.step(x, adjacency, labels));
+        }
+        if (stored == 0) {
+            float acc = accuracy(stack.forward(x, adjacency), labels);
+            check(acc > 0.7f, spec + ": accuracy after training " + to_string(acc));
+        }
+    }
+    check(losses[0] == losses[1], spec + ": checkpointed and stored runs differ");
+    check(losses[0].back() < 0.5f * losses[0].front(),
+          spec + ": loss " + to_string(losses[0].front()) + " -> " + to_string(losses[0].back()));
+}
+
+}  // namespace
+
+int main() {
+    for (bool keep : {false, true}) {
+        GCNLayer gcn(5, 4, 1ull);
+        check_layer(gcn, keep, 101);
+        GraphSAGELayer sage(5, 4, 2ull);
+        check_layer(sage, keep, 102);
+        GATLayer gat(5, 4, 3ull);
+        check_layer(gat, keep, 103);
+    }
+    GCNLayer gcn(5, 4, 4ull);
+    check_stale_intermediates(gcn, 104);
+    GraphSAGELayer sage(5, 4, 5ull);
+    check_stale_intermediates(sage, 105);
+    GATLayer gat(5, 4, 6ull);
+    check_stale_intermediates(gat, 106);
+    for (const string spec : {"gcn:16,gcn:3", "sage:16,gat:3", "gat:8,sage:3"}) {
+        check_training(spec);
+    }
+    return test_result();
+}
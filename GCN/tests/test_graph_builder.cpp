@@ -0,0 +1,134 @@
+// test_graph_builder.cpp
+//
+// GraphBuilder fed by several threads at once must produce the graph that
+// serial Graph::add_edge calls produce (neighbour lists sorted, edge list as
+// a multiset), with and without duplicate and self-loop removal, and must not
+// depend on the number of threads used by build().
+
+#include "GraphBuilder.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+const int kNodes = 500;
+const int kFeatures = 4;
+const int kWriters = 4;
+
+// Random edges with plenty of duplicates and self-loops
+vector<pair<int, int>> random_edges(mt19937_64& gen, int count) {
+    vector<pair<int, int>> edges;
+    for (int e = 0; e < count; e++) {
+        int a = gen() % kNodes;
+        int b = gen() % 8 == 0 ? a : static_cast<int>(gen() % kNodes);
+        edges.emplace_back(a, b);
+        if (gen() % 4 == 0) edges.emplace_back(b, a);
+    }
+    return edges;
+}
+
+// Serial reference: add_edge, then the cleanup build() promises
+Graph serial_graph(const vector<pair<int, int>>& edges, const vector<vector<float>>& features,
+                   const GraphBuilder::Options& options) {
+    Graph g(kNodes, kFeatures);
+    for (int i = 0; i < kNodes; i++) g.set_node_feature(i, features[i]);
+    for (const auto& edge : edges) g.add_edge(edge.first, edge.second);
+    for (int u = 0; u < kNodes; u++) {
+        vector<int>& list = g.adjacency_list[u];
+        sort(list.begin(), list.end());
+        if (options.remove_self_loops) list.erase(remove(list.begin(), list.end(), u), list.end());
+        if (options.remove_duplicates) list.erase(unique(list.begin(), list.end()), list.end());
+    }
+    if (options.remove_self_loops) {
+        g.edge_list.erase(remove_if(g.edge_list.begin(), g.edge_list.end(),
+                                    [](const pair<int, int>& e) { return e.first == e.second; }),
+                          g.edge_list.end());
+    }
+    return g;
+}
+
+// Edges as sorted (min, max) pairs, once each if 'distinct'
+vector<pair<int, int>> normalized(vector<pair<int, int>> edges, bool distinct) {
+    for (auto& edge : edges) {
+        if (edge.first > edge.second) swap(edge.first, edge.second);
+    }
+    sort(edges.begin(), edges.end());
+    if (distinct) edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+Graph concurrent_graph(const vector<pair<int, int>>& edges, const vector<vector<float>>& features,
+                       const GraphBuilder::Options& options) {
+    GraphBuilder builder(kNodes, kFeatures);
+    vector<thread> threads;
+    for (int t = 0; t < kWriters; t++) {
+        threads.emplace_back([&, t] {
+            GraphBuilder::Writer writer = builder.writer();
+            // interleaved slices, so every thread touches every node
+            for (size_t e = t; e < edges.size(); e += kWriters) writer.add_edge(edges[e].first, edges[e].second);
+            for (int i = t; i < kNodes; i += kWriters) builder.set_node_feature(i, features[i]);
+        });
+    }
+    for (auto& worker : threads) worker.join();
+    return builder.build(options);
+}
+
+void check_matches_serial() {
+    mt19937_64 gen(36);
+    vector<pair<int, int>> edges = random_edges(gen, 20000);
+    vector<vector<float>> features = random_matrix(gen, kNodes, kFeatures);
+
+    for (bool dedup : {false, true}) {
+        for (bool drop_loops : {false, true}) {
+            string name = string("dedup ") + (dedup ? "on" : "off") + ", self-loop removal " + (drop_loops ? "on" : "off");
+            GraphBuilder::Options options;
+            options.remove_duplicates = dedup;
+            options.remove_self_loops = drop_loops;
+
+            Graph expected = serial_graph(edges, features, options);
+            Graph built = concurrent_graph(edges, features, options);
+            check(built.num_nodes == kNodes, name + ": wrong node count");
+            check(built.adjacency_list == expected.adjacency_list, name + ": neighbour lists differ");
+            check(built.node_features == expected.node_features, name + ": features differ");
+            check(normalized(built.edge_list, false) == normalized(expected.edge_list, dedup),
+                  name + ": edge lists differ");
+
+            options.num_threads = 1;
+            check(concurrent_graph(edges, features, options).adjacency_list == built.adjacency_list,
+                  name + ": result depends on the build thread count");
+        }
+    }
+}
+
+void check_errors() {
+    GraphBuilder builder(3, 2);
+    GraphBuilder::Writer writer = builder.writer();
+    bool thrown = false;
+    try {
+        writer.add_edge(0, 3);
+    } catch (const out_of_range&) {
+        thrown = true;
+    }
+    check(thrown, "edge to a missing node accepted");
+    thrown = false;
+    try {
+        builder.set_node_feature(1, {1.0f});
+    } catch (const invalid_argument&) {
+        thrown = true;
+    }
+    check(thrown, "feature vector of the wrong size accepted");
+
+    Graph empty = builder.build();
+    check(empty.adjacency_list == vector<vector<int>>(3), "rejected edge was kept");
+    check(empty.edge_list.empty(), "edge list of an empty build is not empty");
+}
+
+}  // namespace
+
+int main() {
+    check_matches_serial();
+    check_errors();
+    return test_result();
+}
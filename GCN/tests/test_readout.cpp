@@ -0,0 +1,182 @@
+// test_readout.cpp
+//
+// Graph readouts and scalar reductions: results must not depend on the thread
+// count (compared exactly), must agree with a naive double-precision
+// reference, and segmented readouts must handle empty and uneven graphs.
+
+#include "Aggregator.h"
+#include "Readout.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+using namespace OutputConverter;
+
+namespace {
+
+const Pooling kPoolings[] = {Pooling::Sum, Pooling::Mean, Pooling::Max, Pooling::Min, Pooling::Attention};
+
+const char* pooling_name(Pooling pooling) {
+    switch (pooling) {
+        case Pooling::Sum: return "sum";
+        case Pooling::Mean: return "mean";
+        case Pooling::Max: return "max";
+        case Pooling::Min: return "min";
+        case Pooling::Attention: return "attention";
+    }
+    return "";
+}
+
+// Straightforward double-precision pooling of rows [begin, end)
+vector<double> naive_readout(
+    const vector<vector<float>>& x, size_t begin, size_t end, Pooling pooling, const vector<float>& gate
+) {
+    size_t dim = x.empty() ? 0 : x[0].size();
+    vector<double> out(dim, 0.0);
+    if (begin == end) return out;
+    if (pooling == Pooling::Max || pooling == Pooling::Min) {
+        for (size_t d = 0; d < dim; d++) {
+            double best = x[begin][d];
+            for (size_t i = begin; i < end; i++) {
+                best = pooling == Pooling::Max ? max<double>(best, x[i][d]) : min<double>(best, x[i][d]);
+            }
+            out[d] = best;
+        }
+        return out;
+    }
+    vector<double> weight(end - begin, 1.0);
+    if (pooling == Pooling::Attention) {
+        vector<double> score(end - begin, 0.0);
+        for (size_t i = begin; i < end; i++) {
+            for (size_t d = 0; d < dim; d++) score[i - begin] += gate[d] * x[i][d];
+        }
+        double top = *max_element(score.begin(), score.end());
+        for (size_t k = 0; k < score.size(); k++) weight[k] = exp(score[k] - top);
+    }
+    double total = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        total += weight[i - begin];
+        for (size_t d = 0; d < dim; d++) out[d] += weight[i - begin] * x[i][d];
+    }
+    double divisor = pooling == Pooling::Sum ? 1.0 : pooling == Pooling::Mean ? end - begin : total;
+    for (double& v : out) v /= divisor;
+    return out;
+}
+
+bool close_to(const vector<float>& got, const vector<double>& expected, double tolerance) {
+    if (got.size() != expected.size()) return false;
+    for (size_t d = 0; d < got.size(); d++) {
+        if (!(fabs(got[d] - expected[d]) <= tolerance * (1.0 + fabs(expected[d])))) return false;
+    }
+    return true;
+}
+
+// Large enough for the parallel path (over 1 << 16 values) and many row blocks
+void check_thread_invariance_and_reference() {
+    mt19937_64 gen(41);
+    int rows = 20000, dim = 8;
+    vector<vector<float>> x = random_matrix(gen, rows, dim);
+    vector<float> gate = random_matrix(gen, 1, dim)[0];
+
+    for (Pooling pooling : kPoolings) {
+        string name = pooling_name(pooling);
+        ReadoutOptions serial, parallel;
+        serial.num_threads = 1;
+        parallel.num_threads = 4;
+        serial.attention_gate = parallel.attention_gate = gate;
+
+        vector<float> one = readout(x, pooling, serial);
+        vector<float> four = readout(x, pooling, parallel);
+        check(one == four, name + ": 1 and 4 threads differ");
+
+        // sums of 20000 values in [-1, 1): pairwise float error stays far below 1e-4
+        double tolerance = pooling == Pooling::Max || pooling == Pooling::Min ? 0.0 : 1e-4;
+        check(close_to(one, naive_readout(x, 0, rows, pooling, gate), tolerance), name + ": differs from the naive reference");
+    }
+}
+
+void check_segments() {
+    mt19937_64 gen(42);
+    int dim = 5;
+    // empty graphs at the start, in the middle and at the end; one graph spans several row blocks
+    vector<size_t> offsets = {0, 0, 1, 4, 4, 3004, 3007, 3100, 3100};
+    vector<vector<float>> x = random_matrix(gen, offsets.back(), dim);
+    vector<float> gate = random_matrix(gen, 1, dim)[0];
+
+    for (Pooling pooling : kPoolings) {
+        string name = pooling_name(pooling);
+        ReadoutOptions options;
+        options.attention_gate = gate;
+        ReadoutOptions serial = options;
+        serial.num_threads = 1;
+
+        vector<vector<float>> pooled = segmentedReadout(x, offsets, pooling, options);
+        check(pooled == segmentedReadout(x, offsets, pooling, serial), name + ": segmented result depends on threads");
+        check(pooled.size() == offsets.size() - 1, name + ": one result per graph expected");
+        for (size_t g = 0; g + 1 < offsets.size() && g < pooled.size(); g++) {
+            string graph = name + " graph " + to_string(g);
+            if (offsets[g] == offsets[g + 1]) {
+                check(pooled[g] == vector<float>(dim, 0.0f), graph + ": empty graph must pool to zeros");
+                continue;
+            }
+            // a graph pooled on its own uses the same blocks, so the result is identical
+            vector<vector<float>> alone(x.begin() + offsets[g], x.begin() + offsets[g + 1]);
+            check(pooled[g] == readout(alone, pooling, options), graph + ": differs from its own readout");
+            double tolerance = pooling == Pooling::Max || pooling == Pooling::Min ? 0.0 : 1e-4;
+            check(close_to(pooled[g], naive_readout(x, offsets[g], offsets[g + 1], pooling, gate), tolerance),
+                  graph + ": differs from the naive reference");
+        }
+    }
+
+    check(readout({}, Pooling::Sum).empty(), "empty matrix must pool to an empty vector");
+
+    auto throws = [](const function<void()>& f) {
+        try {
+            f();
+        } catch (const invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    check(throws([&] { segmentedReadout(x, {0, 10}, Pooling::Sum); }), "offsets not ending at the row count accepted");
+    check(throws([&] { segmentedReadout(x, {0, 20, 10, x.size()}, Pooling::Sum); }), "descending offsets accepted");
+    check(throws([&] { readout({{1.0f, 2.0f}, {3.0f}}, Pooling::Sum); }), "ragged rows accepted");
+    check(throws([&] { readout(x, Pooling::Attention); }), "attention without a gate accepted");
+    check(throws([] { parsePooling("median"); }), "unknown pooling accepted");
+    check(parsePooling("attention") == Pooling::Attention, "parsePooling(attention)");
+}
+
+void check_scalar_reductions() {
+    mt19937_64 gen(43);
+    for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(4097), size_t(200003)}) {
+        vector<float> v(n);
+        for (float& value : v) value = uniform(gen, -1.0f, 1.0f);
+        string size = "n=" + to_string(n);
+
+        check(reduceSum(v.data(), n, 1) == reduceSum(v.data(), n, 4), size + ": reduceSum depends on threads");
+        check(reduceMax(v.data(), n, 1) == reduceMax(v.data(), n, 4), size + ": reduceMax depends on threads");
+        check(reduceMin(v.data(), n, 1) == reduceMin(v.data(), n, 4), size + ": reduceMin depends on threads");
+
+        double sum = 0.0;
+        for (float value : v) sum += value;
+        float largest = n ? *max_element(v.begin(), v.end()) : 0.0f;
+        float smallest = n ? *min_element(v.begin(), v.end()) : 0.0f;
+
+        check(fabs(DefaultAgg::sumGraph(v) - sum) <= 1e-4 * (1.0 + fabs(sum)), size + ": sumGraph");
+        double mean = n ? sum / n : 0.0;
+        check(fabs(DefaultAgg::meanGraph(v) - mean) <= 1e-6 * (1.0 + fabs(mean)), size + ": meanGraph");
+        check(DefaultAgg::maxGraph(v) == largest, size + ": maxGraph");
+        check(DefaultAgg::minGraph(v) == smallest, size + ": minGraph");
+    }
+}
+
+}  // namespace
+
+int main() {
+    check_thread_invariance_and_reference();
+    check_segments();
+    check_scalar_reductions();
+    return test_result();
+}